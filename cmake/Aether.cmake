@@ -2,9 +2,13 @@ set(SOURCE_FILES
     src/Aether/ADT.cpp
     src/Aether/Application.cpp
     src/Aether/DrawingContext.cpp
-    src/Aether/Main.cpp
+    src/Aether/FrameArena.cpp
+    src/Aether/FrameCapture.cpp
+    src/Aether/MeshCache.cpp
     src/Aether/Modifiers.cpp
     src/Aether/Shapes.cpp
+    src/Aether/SoftwareRenderer.cpp
+    src/Aether/ThreadPool.cpp
     src/Aether/Toolbar.cpp
     src/Aether/View.cpp
     src/Aether/ViewUtil.h
@@ -16,8 +20,13 @@ set(HEADER_FILES
     include/Aether/DrawingContext.h
     include/Aether/Event.h
     include/Aether/Event.def
+    include/Aether/FrameArena.h
+    include/Aether/FrameCapture.h
+    include/Aether/MeshCache.h
     include/Aether/Modifiers.h
     include/Aether/Shapes.h
+    include/Aether/SoftwareRenderer.h
+    include/Aether/ThreadPool.h
     include/Aether/Toolbar.h
     include/Aether/Vec.h
     include/Aether/View.h
@@ -29,6 +38,7 @@ add_library(Aether SHARED)
 
 if(APPLE)
     list(APPEND SOURCE_FILES
+        src/Aether/Main.cpp
         src/Aether/MacOS/MacOSRenderer.mm
         src/Aether/MacOS/MacOSMain.mm
         src/Aether/MacOS/MacOSToolbar.mm
@@ -43,8 +53,28 @@ if(APPLE)
         "-framework Metal"
         "-framework QuartzCore"
     )
+else()
+    # Without a native window system views are laid out in memory and drawn
+    # by the software renderer
+    list(APPEND SOURCE_FILES
+        src/Aether/Headless/HeadlessMain.cpp
+        src/Aether/Headless/HeadlessRenderer.cpp
+        src/Aether/Headless/HeadlessToolbar.cpp
+        src/Aether/Headless/HeadlessView.cpp
+        src/Aether/Headless/HeadlessWindow.cpp
+    )
 endif() # APPLE
 
+# GCC only vectorizes the branch free pixel loops if floating point comparisons
+# are not assumed to trap, which is the default with Clang
+if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    set_source_files_properties(src/Aether/SoftwareRenderer.cpp PROPERTIES
+        COMPILE_FLAGS -fno-trapping-math
+    )
+endif()
+
+find_package(Threads REQUIRED)
+
 target_sources(Aether 
     PRIVATE ${HEADER_FILES}
     PRIVATE ${SOURCE_FILES})
@@ -63,6 +93,7 @@ PUBLIC
     vml
 PRIVATE
     range-v3
+    Threads::Threads
     WarningFlags
     Sanitizers
 )
@@ -0,0 +1,14 @@
+add_executable(AetherTests)
+
+target_sources(AetherTests PRIVATE
+    src/AetherTests/AetherTests.cpp
+    src/AetherTests/MeasureCacheTests.cpp
+    src/AetherTests/Tests.h
+    src/AetherTests/TriangulationTests.cpp
+)
+target_link_libraries(AetherTests
+    PRIVATE Aether
+    PRIVATE WarningFlags
+)
+
+add_test(NAME AetherTests COMMAND AetherTests)
@@ -0,0 +1,9 @@
+add_executable(CaptureReplay)
+
+target_sources(CaptureReplay PRIVATE
+    src/CaptureReplay/CaptureReplay.cpp
+)
+target_link_libraries(CaptureReplay
+    PRIVATE Aether
+    PRIVATE WarningFlags Sanitizers
+)
@@ -0,0 +1,9 @@
+add_executable(LayoutBench)
+
+target_sources(LayoutBench PRIVATE
+    src/LayoutBench/LayoutBench.cpp
+)
+target_link_libraries(LayoutBench
+    PRIVATE Aether
+    PRIVATE WarningFlags
+)
@@ -0,0 +1,13 @@
+add_executable(ShapesBench)
+
+# Shapes.cpp is compiled directly into the benchmark so it builds on platforms
+# where the Aether library is not available
+target_sources(ShapesBench PRIVATE
+    src/ShapesBench/ShapesBench.cpp
+    src/Aether/Shapes.cpp
+)
+target_include_directories(ShapesBench PRIVATE include)
+target_link_libraries(ShapesBench
+    PRIVATE vml utility
+    PRIVATE WarningFlags
+)
@@ -1,17 +1,26 @@
 #ifndef AETHER_DRAWINGCONTEXT_H
 #define AETHER_DRAWINGCONTEXT_H
 
+#include <filesystem>
+#include <limits>
+#include <memory>
 #include <span>
+#include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include <utl/function_view.hpp>
 #include <vml/vml.hpp>
 
+#include <Aether/FrameArena.h>
+#include <Aether/MeshCache.h>
 #include <Aether/Shapes.h>
 #include <Aether/Vec.h>
 
 namespace xui {
 
+class FrameCaptureWriter;
 class View;
 
 struct FlatColor {
@@ -30,14 +39,190 @@ struct Gradient {
 using FillMode = std::variant<FlatColor, Gradient>;
 
 struct DrawCallOptions {
+    /// The fill is stored per vertex as an index into a paint table, so draw
+    /// calls with different fills can still be batched. See `DrawData`
     FillMode fill = {};
     bool wireframe = false;
+
+    /// If positive, lines and polygons are surrounded by an anti-aliasing
+    /// fringe of this width in which the coverage falls off to zero. See
+    /// `buildAntialiasingFringe()`
+    float fringeWidth = 0;
+
+    /// If true, duplicate vertices are merged before the anti-aliasing fringe
+    /// is built. Points of lines that are equal to their predecessor are
+    /// dropped before meshing, and vertices of line meshes with equal
+    /// positions are merged with `weldVertices()`. Polygon triangulation always
+    /// ignores repeated contour points
+    bool weldVertices = false;
 };
 
+/// Affine 2D transform that maps `p` to
+/// `p.x * column0 + p.y * column1 + translation`
+struct Transform2D {
+    vml::float2 column0 = { 1, 0 };
+    vml::float2 column1 = { 0, 1 };
+    vml::float2 translation = { 0, 0 };
+
+    /// \Returns a transform that moves points by \p offset
+    static Transform2D Translation(vml::float2 offset) {
+        return { { 1, 0 }, { 0, 1 }, offset };
+    }
+
+    /// \Returns a transform that scales points by \p factor about the origin
+    static Transform2D Scale(vml::float2 factor) {
+        return { { factor.x, 0 }, { 0, factor.y }, { 0, 0 } };
+    }
+
+    /// \overload
+    static Transform2D Scale(float factor) { return Scale({ factor, factor }); }
+
+    /// \Returns a transform that rotates points by \p angle radians about the
+    /// origin
+    static Transform2D Rotation(float angle);
+
+    /// \Returns \p p transformed by this transform
+    vml::float2 operator()(vml::float2 p) const {
+        return p.x * column0 + p.y * column1 + translation;
+    }
+
+    /// Determinant of the linear part. Zero if the transform is not
+    /// invertible
+    float determinant() const {
+        return column0.x * column1.y - column1.x * column0.y;
+    }
+
+    /// \Returns the inverse of this transform. The transform must be
+    /// invertible
+    Transform2D inverse() const;
+};
+
+/// \Returns the transform that applies \p B first and \p A second
+Transform2D operator*(Transform2D const& A, Transform2D const& B);
+
+/// Axis aligned rectangle that draw calls are clipped to, in the coordinate
+/// space of the renderer, i.e., after transformation. The default rectangle
+/// does not clip
+struct ClipRect {
+    vml::float2 min = { -std::numeric_limits<float>::infinity(),
+                        -std::numeric_limits<float>::infinity() };
+    vml::float2 max = { std::numeric_limits<float>::infinity(),
+                        std::numeric_limits<float>::infinity() };
+
+    /// \Returns true if the rectangle contains no points
+    bool empty() const { return !(min.x < max.x && min.y < max.y); }
+};
+
+/// Per instance data of instanced draw calls. Vertices of the mesh are mapped
+/// to `offset + scale * p` before the transform of the draw call is applied
+struct Instance {
+    vml::float2 offset = { 0, 0 };
+    vml::float2 scale = { 1, 1 };
+
+    /// Multiplied with the fill color of the mesh
+    Vec<float, 4> color = Color::White();
+};
+
+/// Type of the indices of a draw call
+enum class IndexType { UInt16, UInt32 };
+
+/// Largest number of vertices a draw call with `IndexType::UInt16` can address
+inline constexpr size_t MaxShortIndexVertices = size_t(1) << 16;
+
+/// Identifies a mesh registered with `DrawingContext::registerMesh()`
+enum class MeshID : uint32_t {};
+
 struct DrawCall {
     size_t beginVertex, endVertex;
     size_t beginIndex, endIndex;
     DrawCallOptions options = {};
+
+    /// Determines whether `beginIndex` and `endIndex` refer to
+    /// `DrawData::indices` or `DrawData::shortIndices`
+    IndexType indexType = IndexType::UInt32;
+
+    /// Transform from the coordinates of the vertices to the coordinate space
+    /// of the renderer. Also applies to the coordinates of gradients
+    Transform2D transform = {};
+
+    ClipRect clipRect = {};
+
+    /// Range of `DrawData::instances`. If the range is not empty, the draw
+    /// call is drawn once per instance
+    size_t beginInstance = 0, endInstance = 0;
+
+    /// \Returns true if the draw call is drawn once per instance
+    bool instanced() const { return beginInstance != endInstance; }
+};
+
+/// Statistics of a call to `DrawingContext::draw()`
+struct DrawStats {
+    /// Number of draw calls recorded during the frame
+    size_t numRecordedDrawCalls = 0;
+
+    /// Number of draw calls passed to the renderer after batching
+    size_t numSubmittedDrawCalls = 0;
+
+    /// Number of draw calls that were merged into a preceding draw call
+    size_t numMergedDrawCalls() const {
+        return numRecordedDrawCalls - numSubmittedDrawCalls;
+    }
+
+    /// Number of retained items whose geometry was reused
+    size_t numReusedItems = 0;
+
+    /// Number of retained items that were recorded anew
+    size_t numRebuiltItems = 0;
+
+    /// Number of vertices and indices that differ from the previous frame
+    size_t numDirtyVertices = 0, numDirtyIndices = 0;
+
+    /// Number of bytes allocated from `DrawingContext::frameArena()`
+    size_t numScratchBytes = 0;
+};
+
+/// Half open range of elements that changed since the previous frame. The
+/// default range covers all elements
+struct DirtyRange {
+    size_t begin = 0;
+    size_t end = std::numeric_limits<size_t>::max();
+};
+
+/// Everything a `Renderer` draws in one frame
+struct DrawData {
+    std::span<vml::float2 const> vertices;
+
+    /// One entry per vertex that is multiplied into the alpha of the fill
+    std::span<float const> coverage;
+
+    /// One entry per vertex that indexes into `paints`. Triangles are filled
+    /// with the paint of their first vertex
+    std::span<uint32_t const> paintIndices;
+
+    /// The fills used by the frame
+    std::span<FillMode const> paints;
+
+    /// Triangle indices of draw calls with `IndexType::UInt32`, relative to
+    /// the first vertex of each draw call
+    std::span<uint32_t const> indices;
+
+    /// Triangle indices of draw calls with `IndexType::UInt16`, relative to
+    /// the first vertex of each draw call
+    std::span<uint16_t const> shortIndices;
+
+    std::span<DrawCall const> drawCalls;
+
+    /// Instances of instanced draw calls
+    std::span<Instance const> instances;
+
+    /// Range of vertices whose position, coverage or paint index differ from
+    /// the previous call to `Renderer::render()`. Renderers that keep the data
+    /// of the previous frame only have to update this range
+    DirtyRange dirtyVertices;
+
+    /// Ranges of indices and short indices that differ from the previous call
+    /// to `Renderer::render()`
+    DirtyRange dirtyIndices, dirtyShortIndices;
 };
 
 /// Platform independent renderer interface
@@ -45,9 +230,8 @@ class Renderer {
 public:
     virtual ~Renderer() = default;
 
-    virtual void render(std::span<vml::float2 const> vertices,
-                        std::span<uint32_t const> indices,
-                        std::span<DrawCall const> drawCalls) = 0;
+    /// Draws the draw calls of \p data
+    virtual void render(DrawData const& data) = 0;
 };
 
 ///
@@ -68,19 +252,28 @@ std::unique_ptr<Renderer> createRenderer(View* view,
 /// Wrapper around a `Renderer` that provides convenience drawing functions
 class DrawingContext {
 public:
-    explicit DrawingContext(View* view, RendererOptions const& options):
-        renderer(createRenderer(view, options)) {}
+    explicit DrawingContext(View* view, RendererOptions const& options);
+
+    ~DrawingContext();
 
     /// Creates a draw call that draws \p line
     void addLine(std::span<vml::float2 const> line,
                  DrawCallOptions const& drawOptions = {},
                  LineMeshOptions const& meshOptions = {});
 
-    /// Creates a draw call that draws \p polygon
+    /// Creates a draw call that draws \p polygon. Triangulations are cached by
+    /// the shape of the polygon, so redrawing the same polygon, also at a
+    /// different position, does not triangulate it again
     void addPolygon(std::span<vml::float2 const> polygon,
                     DrawCallOptions const& drawOptions = {},
                     TriangulationOptions const& meshOptions = {});
 
+    /// Creates a single draw call that draws the polygon bounded by
+    /// \p contours, e.g., a polygon with holes
+    void addPolygon(std::span<std::span<vml::float2 const> const> contours,
+                    DrawCallOptions const& drawOptions = {},
+                    TriangulationOptions const& meshOptions = {});
+
     /// Stateful rendering interface @{
 
     /// Invokes \p fn between a call to `beginDrawCall()` and `endDrawCall()`
@@ -99,11 +292,22 @@ public:
     void beginDrawCall(DrawCallOptions options = {}) {
         currentDC = { .beginVertex = vertices.size(),
                       .beginIndex = indices.size(),
-                      .options = options };
+                      .options = options,
+                      .transform = currentTransform,
+                      .clipRect = currentClipRect };
+        setFill(options.fill);
     }
 
+    /// Sets the fill of the vertices added after this call. Allows drawing
+    /// shapes with different fills in a single draw call
+    void setFill(FillMode const& fill);
+
     /// Adds a vertex to the currently recording draw call
-    void addVertex(vml::float2 p) { vertices.push_back(p); }
+    void addVertex(vml::float2 p, float coverage = 1) {
+        vertices.push_back(p);
+        this->coverage.push_back(coverage);
+        paintIndices.push_back(currentPaint);
+    }
 
     ///
     void addTriangle(uint32_t a, uint32_t b, uint32_t c) {
@@ -133,20 +337,272 @@ public:
 
     /// @}
 
-    /// Draws the recorded draw calls
+    /// Transform and clip state @{
+
+    /// Applies \p transform to the draw calls recorded until the matching
+    /// call to `popTransform()`, before the current transform. Must not be
+    /// called while recording a draw call
+    void pushTransform(Transform2D const& transform);
+
+    /// Restores the transform of before the matching call to
+    /// `pushTransform()`
+    void popTransform();
+
+    /// The transform of draw calls recorded now
+    Transform2D const& transform() const { return currentTransform; }
+
+    /// Clips the draw calls recorded until the matching call to
+    /// `popClipRect()` to the rectangle from \p min to \p max, intersected
+    /// with the current clip rectangle. The rectangle is transformed by the
+    /// current transform. If the transform rotates, the bounding box of the
+    /// transformed rectangle is used. Must not be called while recording a
+    /// draw call
+    void pushClipRect(vml::float2 min, vml::float2 max);
+
+    /// Restores the clip rectangle of before the matching call to
+    /// `pushClipRect()`
+    void popClipRect();
+
+    /// The clip rectangle of draw calls recorded now
+    ClipRect const& clipRect() const { return currentClipRect; }
+
+    /// @}
+
+    /// Instanced rendering interface @{
+
+    /// Records the draw calls issued by \p fn as a mesh that can be drawn
+    /// many times with `addInstances()`. The draw calls are not drawn by
+    /// themselves. The mesh is kept until it is released with
+    /// `releaseMesh()`. Must not be called while recording a draw call
+    MeshID registerMesh(std::invocable auto&& fn) {
+        auto recording = beginItem();
+        std::invoke(fn);
+        return endMesh(recording);
+    }
+
+    /// Discards the mesh \p mesh
+    void releaseMesh(MeshID mesh);
+
+    /// Draws the mesh \p mesh once for every element of \p instances. The
+    /// geometry of the mesh is added to the frame once, regardless of the
+    /// number of instances. Must not be called while recording a draw call
+    void addInstances(MeshID mesh, std::span<Instance const> instances);
+
+    /// @}
+
+    /// Retained rendering interface @{
+
+    /// Records the draw calls issued by \p fn as the retained item \p key.
+    /// If the item was recorded with the same \p version in the previous frame,
+    /// its geometry is reused and \p fn is not invoked. Callers change
+    /// \p version whenever the content of the item changes. Items that are
+    /// not recorded during a frame are discarded by `draw()`. The geometry
+    /// is stored relative to the current transform and clip rectangle, so an
+    /// item can be reused after they change. Must not be called while
+    /// recording a draw call
+    void recordItem(uint64_t key, uint64_t version, std::invocable auto&& fn) {
+        if (replayItem(key, version)) {
+            return;
+        }
+        auto recording = beginItem();
+        std::invoke(fn);
+        endItem(key, version, recording);
+    }
+
+    /// @}
+
+    /// Parallel recording interface @{
+
+    /// Invokes \p fn for every index in `[0, count)` on multiple threads. Each
+    /// invocation records into the shard passed to \p fn, a context without
+    /// renderer that starts with the current transform and clip rectangle.
+    /// Indices are split into contiguous ranges, one per shard, and the shards
+    /// are appended to this context in the order of their ranges, so the
+    /// result is the same as if \p fn was invoked for all indices in order.
+    /// Shards are kept across frames, so their mesh caches and retained items
+    /// stay warm as long as the same indices are recorded. Shards cannot draw
+    /// meshes registered with this context and cannot record in parallel
+    /// themselves. Must not be called while recording a draw call
+    void recordParallel(size_t count,
+                        utl::function_view<void(DrawingContext&, size_t)> fn);
+
+    /// Sets the number of threads used by `recordParallel()`. If \p count is
+    /// zero, all threads of `ThreadPool::shared()` are used. Recording never
+    /// uses more threads than the shared pool has
+    void setNumRecordingThreads(size_t count) { numRecordingThreads = count; }
+
+    /// @}
+
+    /// Draws the recorded draw calls. Consecutive draw calls with the same
+    /// wireframe state, transform and clip rectangle are merged into a single
+    /// draw call first. Draw calls with at most `MaxShortIndexVertices`
+    /// vertices are drawn with 16 bit indices
     void draw();
 
+    /// \Returns statistics of the last call to `draw()`
+    DrawStats const& drawStats() const { return stats; }
+
+    /// Scratch memory for temporary buffers of the frame being recorded,
+    /// e.g., paths that are passed to `addLine()` or `addPolygon()`. All
+    /// allocations are released at the end of `draw()`
+    FrameArena& frameArena() { return _frameArena; }
+
+    /// Frame capture @{
+
+    /// Writes the draw data of every following call to `draw()` to a capture
+    /// file at \p path that can be replayed with `FrameCaptureReader`. Ends a
+    /// running capture first. \Returns false if the file cannot be created
+    bool startCapture(std::filesystem::path const& path);
+
+    /// Ends the running capture and closes its file
+    void stopCapture();
+
+    /// \Returns true if frames are being captured
+    bool isCapturing() const { return capture != nullptr; }
+
+    /// @}
+
     /// Returns the underlying renderer
     Renderer* getRenderer() { return renderer.get(); }
 
 private:
+    struct ShardTag {};
+
+    /// Creates a recording shard for `recordParallel()`
+    explicit DrawingContext(ShardTag);
+
+    /// Appends the draw calls recorded by \p shard and clears its buffers
+    void mergeShard(DrawingContext& shard);
+
+    /// Clears the buffers of the frame being recorded
+    void clearFrame();
+
+    /// Clears the buffers and evicts cached meshes and retained items that were
+    /// not used during the frame
+    void endFrame();
+
     void addDrawCall(DrawCall drawCall);
 
+    /// Merges runs of consecutive draw calls that can be drawn together.
+    /// Indices of merged draw calls are rebased to the first vertex of the run
+    void batchDrawCalls();
+
+    /// Moves the indices of draw calls that can use 16 bit indices to
+    /// `shortIndices` and compacts the remaining indices
+    void packIndices();
+
+    /// Appends space for \p size vertices and indices to the current draw call
+    /// and returns the appended ranges
+    std::pair<std::span<vml::float2>, std::span<uint32_t>> allocate(
+        MeshSize size);
+
+    /// Gives back the unused part of the last `allocate()` call
+    void shrink(MeshSize allocated, MeshSize used);
+
+    /// Merges vertices of the current draw call with equal positions
+    void weldCurrentMesh();
+
+    /// Surrounds the mesh of the current draw call by an anti-aliasing fringe
+    /// of width \p width. Does nothing if \p width is not positive
+    void addAntialiasingFringe(float width);
+
+    /// Appends the mesh cached under \p key to the current draw call.
+    /// \Returns false if there is no such mesh
+    bool addCachedMesh(MeshKey const& key);
+
+    /// Caches the mesh of the current draw call under \p key
+    void cacheCurrentMesh(MeshKey const& key);
+
+    /// State of the frame when recording of a retained item or mesh began
+    struct ItemRecording {
+        size_t beginVertex, beginIndex, beginDrawCall, beginInstance;
+        Transform2D transform;
+        ClipRect clipRect;
+    };
+
+    /// Geometry of a retained item or registered mesh. Vertices, draw calls
+    /// and instances are relative to the beginning of the geometry, paint
+    /// indices index into `paints`
+    struct RecordedGeometry {
+        std::vector<vml::float2> vertices;
+        std::vector<float> coverage;
+        std::vector<uint32_t> paintIndices;
+        std::vector<FillMode> paints;
+        std::vector<uint32_t> indices;
+        std::vector<DrawCall> drawCalls;
+        std::vector<Instance> instances;
+    };
+
+    struct RetainedItem {
+        uint64_t version = 0;
+        bool used = true;
+        RecordedGeometry geometry;
+    };
+
+    /// Appends the geometry of the retained item \p key if it was recorded
+    /// with \p version. \Returns false otherwise
+    bool replayItem(uint64_t key, uint64_t version);
+
+    /// Resets the transform and clip rectangle so the item is recorded
+    /// relative to them
+    ItemRecording beginItem();
+
+    /// Stores the geometry recorded since \p recording began as the retained
+    /// item \p key and restores the transform and clip rectangle
+    void endItem(uint64_t key, uint64_t version,
+                 ItemRecording const& recording);
+
+    /// Moves the geometry recorded since \p recording began out of the frame
+    /// into a new mesh and restores the transform and clip rectangle
+    MeshID endMesh(ItemRecording const& recording);
+
+    /// \Returns a copy of the geometry recorded since \p recording began
+    RecordedGeometry captureGeometry(ItemRecording const& recording);
+
+    /// Appends \p geometry to the frame in the coordinate space of the
+    /// current transform and clip rectangle. If \p instances is not empty,
+    /// every draw call of \p geometry is drawn once per instance
+    void appendGeometry(RecordedGeometry const& geometry,
+                        std::span<Instance const> instances = {});
+
+    /// Moves the item relative draw call \p dc into the coordinate space of
+    /// the current transform and clip rectangle
+    DrawCall placeItemDrawCall(DrawCall dc) const;
+
     DrawCall currentDC{};
     std::unique_ptr<Renderer> renderer;
+    FrameArena _frameArena;
     std::vector<vml::float2> vertices;
+    std::vector<float> coverage;
+    std::vector<uint32_t> paintIndices;
+    std::vector<FillMode> paints;
+    uint32_t currentPaint = 0;
     std::vector<uint32_t> indices;
+    std::vector<uint16_t> shortIndices;
     std::vector<DrawCall> drawCalls;
+    std::vector<Instance> instances;
+    MeshCache meshCache;
+    Transform2D currentTransform;
+    std::vector<Transform2D> transformStack;
+    ClipRect currentClipRect;
+    std::vector<ClipRect> clipRectStack;
+    std::unordered_map<uint64_t, RetainedItem> items;
+    std::unordered_map<MeshID, RecordedGeometry> meshes;
+    uint32_t nextMeshID = 0;
+    std::unique_ptr<FrameCaptureWriter> capture;
+    std::vector<std::unique_ptr<DrawingContext>> shards;
+    size_t numRecordingThreads = 0;
+    bool isShard = false;
+
+    /// The data of the previous frame to compute dirty ranges
+    std::vector<vml::float2> previousVertices;
+    std::vector<float> previousCoverage;
+    std::vector<uint32_t> previousPaintIndices;
+    std::vector<uint32_t> previousIndices;
+    std::vector<uint16_t> previousShortIndices;
+
+    /// Statistics of the frame being recorded and of the last frame
+    DrawStats frameStats, stats;
 };
 
 } // namespace xui
@@ -1,6 +1,8 @@
 #ifndef AETHER_EVENT_H
 #define AETHER_EVENT_H
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <type_traits>
 
@@ -20,6 +22,22 @@ enum class EventType {
 #include <Aether/Event.def>
 };
 
+/// Number of event types including abstract ones
+inline constexpr size_t NumEventTypes =
+#define AETHER_EVENT_TYPE_DEF(Name, ...) +1
+#include <Aether/Event.def>
+    ;
+
+/// Set of event types with one bit per `EventType`
+using EventTypeMask = uint32_t;
+
+static_assert(NumEventTypes <= 32, "Event types must fit into EventTypeMask");
+
+/// \Returns the bit of \p type in an `EventTypeMask`
+constexpr EventTypeMask eventTypeBit(EventType type) {
+    return EventTypeMask(1) << (size_t)type;
+}
+
 /// Forward declarations of all event types
 #define AETHER_EVENT_TYPE_DEF(Name, ...) class Name;
 #include <Aether/Event.def>
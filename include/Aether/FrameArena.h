@@ -0,0 +1,79 @@
+#ifndef AETHER_FRAMEARENA_H
+#define AETHER_FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace xui {
+
+/// Bump allocator for scratch memory that lives until the end of a frame.
+/// Allocations are carved from large blocks and are released all at once by
+/// `reset()`. Deallocating the most recent allocation gives its memory back,
+/// so a growing vector that is the last allocation does not waste its old
+/// storage; other deallocations do nothing.
+///
+/// If a frame needs more than one block, `reset()` replaces the blocks by a
+/// single block large enough for all of them. Frames that use no more memory
+/// than the largest previous frame therefore do not allocate from the heap
+class FrameArena: public std::pmr::memory_resource {
+public:
+    /// Creates an arena whose first block has \p initialSize bytes. The block
+    /// is allocated on first use
+    explicit FrameArena(size_t initialSize = 64 << 10);
+
+    FrameArena(FrameArena const&) = delete;
+    FrameArena& operator=(FrameArena const&) = delete;
+
+    ~FrameArena() override;
+
+    /// Releases all allocations. Memory allocated from the arena must not be
+    /// used after this call
+    void reset();
+
+    /// Number of bytes allocated since the last call to `reset()`, including
+    /// padding for alignment
+    size_t bytesUsed() const { return used + (top - blockBegin()); }
+
+    /// Total size of all blocks
+    size_t capacity() const;
+
+    /// Number of blocks allocated from the heap since construction. Does not
+    /// change during frames that fit into the arena
+    size_t numHeapAllocations() const { return _numHeapAllocations; }
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override;
+
+    void do_deallocate(void* p, size_t size, size_t alignment) override;
+
+    bool do_is_equal(
+        std::pmr::memory_resource const& other) const noexcept override {
+        return this == &other;
+    }
+
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::byte* blockBegin() const {
+        return blocks.empty() ? nullptr : blocks.back().data.get();
+    }
+
+    /// Appends a block with room for at least \p size bytes
+    void addBlock(size_t size);
+
+    std::vector<Block> blocks;
+    /// Bytes allocated in all but the last block
+    size_t used = 0;
+    std::byte* top = nullptr;
+    std::byte* end = nullptr;
+    size_t nextBlockSize;
+    size_t _numHeapAllocations = 0;
+};
+
+} // namespace xui
+
+#endif // AETHER_FRAMEARENA_H
@@ -0,0 +1,81 @@
+#ifndef AETHER_FRAMECAPTURE_H
+#define AETHER_FRAMECAPTURE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <Aether/DrawingContext.h>
+
+namespace xui {
+
+/// Version of the capture file format written by `FrameCaptureWriter`
+inline constexpr uint32_t FrameCaptureVersion = 1;
+
+/// Writes the `DrawData` of consecutive frames to a binary file, so a session
+/// can be replayed into a `Renderer` later without the application that
+/// produced it. The file starts with a magic number and the format version,
+/// followed by one record per frame. All values are stored in the byte order
+/// of the host. Vertices, coverage and indices are stored as raw arrays,
+/// draw calls, paints and instances field by field
+class FrameCaptureWriter {
+public:
+    /// Creates the file at \p path. Check `isOpen()` for success
+    explicit FrameCaptureWriter(std::filesystem::path const& path);
+
+    /// \Returns true if the file was created and all writes succeeded so far
+    bool isOpen() const { return file.good(); }
+
+    /// Appends \p data as the next frame
+    void write(DrawData const& data);
+
+    /// Number of frames written so far
+    size_t numFrames() const { return _numFrames; }
+
+private:
+    std::ofstream file;
+    size_t _numFrames = 0;
+};
+
+/// A frame read by `FrameCaptureReader`. Owns the buffers that `drawData()`
+/// refers to
+struct CapturedFrame {
+    std::vector<vml::float2> vertices;
+    std::vector<float> coverage;
+    std::vector<uint32_t> paintIndices;
+    std::vector<FillMode> paints;
+    std::vector<uint32_t> indices;
+    std::vector<uint16_t> shortIndices;
+    std::vector<DrawCall> drawCalls;
+    std::vector<Instance> instances;
+    DirtyRange dirtyVertices, dirtyIndices, dirtyShortIndices;
+
+    /// \Returns a view of the frame that can be passed to
+    /// `Renderer::render()`. Invalidated when the frame is read into again
+    DrawData drawData() const;
+};
+
+/// Reads the frames written by `FrameCaptureWriter`
+class FrameCaptureReader {
+public:
+    /// Opens the capture at \p path. Check `isOpen()` for success
+    explicit FrameCaptureReader(std::filesystem::path const& path);
+
+    /// \Returns true if the file was opened and starts with a valid header of
+    /// a supported version
+    bool isOpen() const { return valid; }
+
+    /// Reads the next frame into \p frame, reusing its buffers. \Returns false
+    /// at the end of the capture or if the frame is malformed, in which case
+    /// the contents of \p frame are unspecified
+    bool read(CapturedFrame& frame);
+
+private:
+    std::ifstream file;
+    bool valid = false;
+};
+
+} // namespace xui
+
+#endif // AETHER_FRAMECAPTURE_H
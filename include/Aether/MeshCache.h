@@ -0,0 +1,100 @@
+#ifndef AETHER_MESHCACHE_H
+#define AETHER_MESHCACHE_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vml/vml.hpp>
+
+namespace xui {
+
+/// Identifies a mesh by the geometry and the parameters it was built from.
+/// Geometry is stored relative to its first point, so translated copies of the
+/// same path compare equal
+class MeshKey {
+public:
+    /// Creates the key for a mesh built from \p contours. \p params encode
+    /// everything besides the geometry that affects the mesh, e.g., the kind of
+    /// mesh and its options. The key is stored in memory from \p memory, or
+    /// the default memory resource if it is null. Copies of the key always
+    /// use the default memory resource, so lookup keys can live in scratch
+    /// memory
+    MeshKey(std::span<std::span<vml::float2 const> const> contours,
+            std::span<uint32_t const> params,
+            std::pmr::memory_resource* memory = nullptr);
+
+    /// \overload for a single contour
+    MeshKey(std::span<vml::float2 const> contour,
+            std::span<uint32_t const> params,
+            std::pmr::memory_resource* memory = nullptr):
+        MeshKey(std::span(&contour, 1), params, memory) {}
+
+    /// The first point of the geometry. Cached vertices are relative to this
+    vml::float2 origin() const { return _origin; }
+
+    /// Hash of the relative geometry and the parameters
+    size_t hash() const { return _hash; }
+
+    bool operator==(MeshKey const& rhs) const {
+        return _hash == rhs._hash && params == rhs.params &&
+               geometry == rhs.geometry;
+    }
+
+private:
+    vml::float2 _origin{};
+    std::pmr::vector<vml::float2> geometry;
+    std::pmr::vector<uint32_t> params;
+    size_t _hash = 0;
+};
+
+/// Vertices, per vertex coverage and triangle indices of a cached mesh.
+/// Vertices are relative to the origin of the key the mesh is cached under
+struct CachedMesh {
+    std::vector<vml::float2> vertices;
+    std::vector<float> coverage;
+    std::vector<uint32_t> indices;
+};
+
+/// Cache of tessellated meshes keyed by the geometry they were built from.
+/// Meshes that are not used between two calls to `collect()` are evicted
+class MeshCache {
+public:
+    /// \Returns the mesh cached under \p key or null if there is none
+    CachedMesh const* find(MeshKey const& key);
+
+    /// Caches the mesh \p vertices, \p coverage and \p indices under a copy of
+    /// \p key. \p vertices are absolute and are stored relative to
+    /// `key.origin()`
+    void insert(MeshKey const& key, std::span<vml::float2 const> vertices,
+                std::span<float const> coverage,
+                std::span<uint32_t const> indices);
+
+    /// Evicts all meshes that have not been inserted or found since the last
+    /// call to `collect()`
+    void collect();
+
+    /// Number of cached meshes
+    size_t size() const { return entries.size(); }
+
+    /// Evicts all meshes
+    void clear() { entries.clear(); }
+
+private:
+    struct Entry {
+        CachedMesh mesh;
+        bool used = true;
+    };
+
+    struct KeyHash {
+        size_t operator()(MeshKey const& key) const { return key.hash(); }
+    };
+
+    std::unordered_map<MeshKey, Entry, KeyHash> entries;
+};
+
+} // namespace xui
+
+#endif // AETHER_MESHCACHE_H
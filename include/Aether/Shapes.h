@@ -1,6 +1,8 @@
 #ifndef AETHER_SHAPES_H
 #define AETHER_SHAPES_H
 
+#include <array>
+#include <memory_resource>
 #include <span>
 
 #include <utl/function_view.hpp>
@@ -11,7 +13,18 @@ namespace xui {
 enum class Orientation { Counterclockwise, Clockwise };
 
 struct BezierOptions {
+    /// Number of line segments the curve is flattened into. Ignored if
+    /// `tolerance` is positive
     int numSegments = 30;
+
+    /// If positive, the number of segments is chosen per curve such that the
+    /// flattened path deviates from the curve by at most `tolerance` pixels
+    float tolerance = 0;
+
+    /// Scale from curve coordinates to pixels, e.g., the zoom factor of the
+    /// view. Only relevant if `tolerance` is positive
+    float scale = 1;
+
     bool emitFirstPoint = true;
     bool emitLastPoint = true;
 };
@@ -20,9 +33,38 @@ void pathBezier(std::span<vml::float2 const> controlPoints,
                 utl::function_view<void(vml::float2)> vertexEmitter,
                 BezierOptions options = {});
 
+/// Number of vertices `pathBezier()` emits for the curve \p controlPoints
+size_t bezierVertexCount(std::span<vml::float2 const> controlPoints,
+                         BezierOptions options = {});
+
+/// Control points of a cubic Bezier curve
+using CubicBezier = std::array<vml::float2, 4>;
+
+/// Flattens all curves in \p curves into the contiguous buffer \p vertices.
+/// The vertices of the curves are written back to back, if \p ends is not
+/// empty, `ends[i]` is set to the end of the vertices of curve `i`.
+/// \p vertices must have room for the sum of `bezierVertexCount()` of all
+/// curves.
+/// \Returns the total number of vertices written
+size_t pathBeziers(std::span<CubicBezier const> curves,
+                   std::span<vml::float2> vertices, std::span<size_t> ends = {},
+                   BezierOptions options = {});
+
 struct CircleSegmentOptions {
     Orientation orientation = Orientation::Counterclockwise;
+
+    /// Number of line segments the arc is flattened into. Ignored if
+    /// `tolerance` is positive
     int numSegments = 20;
+
+    /// If positive, the number of segments is chosen such that the flattened
+    /// path deviates from the arc by at most `tolerance` pixels
+    float tolerance = 0;
+
+    /// Scale from arc coordinates to pixels, e.g., the zoom factor of the view.
+    /// Only relevant if `tolerance` is positive
+    float scale = 1;
+
     bool emitFirst = true;
     bool emitLast = true;
 };
@@ -38,10 +80,44 @@ struct LineCapOptions {
     int numSegments = 20;
 };
 
+struct LineJoinOptions {
+    enum Style { Miter, Bevel, Round };
+
+    Style style = Miter;
+
+    /// Maximum ratio of the miter length to the line width. Miter joins at
+    /// sharper angles are beveled
+    float miterLimit = 4;
+
+    /// Number of segments of a round join that turns by 180 degrees. Joins at
+    /// smaller angles use proportionally fewer segments
+    int numSegments = 20;
+};
+
+struct LineDashOptions {
+    /// Alternating lengths of dashes and gaps, beginning with a dash. A pattern
+    /// with an odd number of entries is repeated twice. Dashes of length zero
+    /// are not drawn. An empty pattern draws a solid line
+    std::span<float const> pattern;
+
+    /// Distance into the pattern at which the line begins
+    float phase = 0;
+};
+
 struct LineMeshOptions {
     float width = 10;
     bool closed = false;
+    LineJoinOptions join;
+
+    /// All dashes are emitted into the same mesh and every dash gets the caps
+    /// `beginCap` and `endCap`
+    LineDashOptions dash;
+
     LineCapOptions beginCap, endCap;
+
+    /// Memory for temporary buffers, e.g., a `FrameArena`. Uses the default
+    /// memory resource if null
+    std::pmr::memory_resource* scratch = nullptr;
 };
 
 void buildLineMesh(
@@ -50,21 +126,111 @@ void buildLineMesh(
     utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
     LineMeshOptions options);
 
+/// Number of vertices and indices of a mesh
+struct MeshSize {
+    size_t numVertices = 0;
+    size_t numIndices = 0;
+};
+
+/// \Returns an upper bound for the number of vertices and indices
+/// `buildLineMesh()` emits for \p line
+MeshSize lineMeshSize(std::span<vml::float2 const> line,
+                      LineMeshOptions const& options);
+
+/// Same as `buildLineMesh()` but writes the mesh directly into \p vertices
+/// and \p indices instead of invoking an emitter per vertex and triangle. The
+/// buffers must be at least as large as `lineMeshSize()`.
+/// \Returns the number of vertices and indices written
+MeshSize buildLineMeshInto(std::span<vml::float2 const> line,
+                           std::span<vml::float2> vertices,
+                           std::span<uint32_t> indices,
+                           LineMeshOptions options);
+
+/// Determines which regions of a polygon with multiple contours are filled
+enum class FillRule {
+    /// Regions are filled if a ray from them crosses the contours an odd number
+    /// of times
+    EvenOdd,
+    /// Regions are filled if the winding number of the contours around them is
+    /// not zero
+    NonZero,
+};
+
 struct TriangulationOptions {
     /// Y monotone polygons are polygons for which each horizonal line only
     /// intersects the polygon atmost twice. Y monotone polygons can be
-    /// triangulated in linear time
+    /// triangulated in linear time. Other simple polygons are decomposed into
+    /// Y monotone pieces first, which takes O(n log n)
     bool isYMonotone = false;
 
     /// Required when `isYMonotone` is true
     Orientation orientation = {};
+
+    /// Only relevant for polygons with multiple contours
+    FillRule fillRule = FillRule::EvenOdd;
+
+    /// Memory for temporary buffers, e.g., a `FrameArena`. Uses the default
+    /// memory resource if null
+    std::pmr::memory_resource* scratch = nullptr;
 };
 
+/// Triangulates the simple polygon \p vertices. The orientation of the polygon
+/// is only required if `options.isYMonotone` is true
 void triangulatePolygon(
     std::span<vml::float2 const> vertices,
     utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
     TriangulationOptions options = {});
 
+/// Triangulates the polygon bounded by \p contours, e.g., a polygon with holes.
+/// Contours must be simple and must not intersect each other, but they may be
+/// nested. Which regions are filled is determined by `options.fillRule`.
+/// Vertices are indexed as if all contours were concatenated
+void triangulatePolygon(
+    std::span<std::span<vml::float2 const> const> contours,
+    utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
+    TriangulationOptions options = {});
+
+/// \Returns an upper bound for the number of indices `triangulatePolygon()`
+/// emits for a polygon with \p numVertices vertices in \p numContours contours
+size_t polygonIndexCount(size_t numVertices, size_t numContours = 1);
+
+/// Same as `triangulatePolygon()` but writes the triangle indices directly into
+/// \p indices. \p indices must be at least as large as `polygonIndexCount()`.
+/// \Returns the number of indices written
+size_t triangulatePolygonInto(std::span<vml::float2 const> vertices,
+                              std::span<uint32_t> indices,
+                              TriangulationOptions options = {});
+
+/// \overload
+size_t triangulatePolygonInto(
+    std::span<std::span<vml::float2 const> const> contours,
+    std::span<uint32_t> indices, TriangulationOptions options = {});
+
+/// Builds an anti-aliasing fringe around the triangle mesh \p vertices and
+/// \p indices, e.g., the output of `buildLineMesh()` or `triangulatePolygon()`.
+/// Every boundary edge of the mesh is extruded outwards by \p width. Fringe
+/// vertices are meant to be drawn with a coverage of 0 and mesh vertices with a
+/// coverage of 1, so the coverage falls off linearly across the fringe.
+/// Fringe vertices are indexed after the mesh vertices, i.e., the first fringe
+/// vertex has index `vertices.size()`. Temporary buffers are allocated from
+/// \p scratch or from the default memory resource if it is null
+void buildAntialiasingFringe(
+    std::span<vml::float2 const> vertices, std::span<uint32_t const> indices,
+    utl::function_view<void(vml::float2)> vertexEmitter,
+    utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
+    float width = 1, std::pmr::memory_resource* scratch = nullptr);
+
+/// Merges vertices of the mesh \p vertices and \p indices that have equal
+/// positions, e.g., where line segments, joins and caps meet or where a
+/// polygon repeats a point. The remaining vertices are moved to the front of
+/// \p vertices in their original order and \p indices are remapped. Triangles
+/// that become degenerate are removed. Temporary buffers are allocated from
+/// \p scratch or from the default memory resource if it is null.
+/// \Returns the number of remaining vertices and indices
+MeshSize weldVertices(std::span<vml::float2> vertices,
+                      std::span<uint32_t> indices,
+                      std::pmr::memory_resource* scratch = nullptr);
+
 } // namespace xui
 
 #endif // AETHER_SHAPES_H
@@ -0,0 +1,75 @@
+#ifndef AETHER_SOFTWARERENDERER_H
+#define AETHER_SOFTWARERENDERER_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <Aether/DrawingContext.h>
+
+namespace xui {
+
+/// Platform independent `Renderer` that rasterizes into an in-memory image.
+/// The image has the same contents a GPU renderer would present, i.e., RGBA8
+/// with premultiplied alpha, cleared to transparent black on every `render()`
+/// call. Vertices are in points and are scaled by `scale()` to pixels.
+/// The image is divided into tiles that are rasterized in parallel. Triangles
+/// are drawn in order within each tile, so the output does not depend on the
+/// number of threads
+class SoftwareRenderer: public Renderer {
+public:
+    /// Edge length of the square tiles in pixels
+    static constexpr size_t TileSize = 64;
+
+    /// Creates a renderer that draws into an image of \p width by \p height
+    /// pixels. Tiles are rasterized on at most \p numThreads threads of
+    /// `ThreadPool::shared()`, or on all of them if \p numThreads is zero
+    explicit SoftwareRenderer(size_t width = 0, size_t height = 0,
+                              RendererOptions const& options = {},
+                              size_t numThreads = 0);
+
+    /// Creates a renderer that resizes the image to the size of \p view scaled
+    /// by `scale()` before every `render()` call
+    explicit SoftwareRenderer(View* view, RendererOptions const& options = {},
+                              size_t numThreads = 0);
+
+    void render(DrawData const& data) override;
+
+    /// Resizes the image to \p width by \p height pixels and clears it
+    void resize(size_t width, size_t height);
+
+    /// Width of the image in pixels
+    size_t width() const { return _width; }
+
+    /// Height of the image in pixels
+    size_t height() const { return _height; }
+
+    /// Number of pixels per point
+    float scale() const { return _scale; }
+
+    /// Sets the number of pixels per point
+    void setScale(float scale) { _scale = scale; }
+
+    /// The image of the last `render()` call. Rows are stored top to bottom
+    /// without padding, 4 bytes per pixel
+    std::span<uint8_t const> pixels() const { return _pixels; }
+
+    /// \Returns the RGBA value of the pixel at \p x, \p y packed with red in
+    /// the lowest byte
+    uint32_t pixel(size_t x, size_t y) const;
+
+private:
+    View* view = nullptr;
+    RendererOptions options;
+    size_t numThreads = 0;
+    size_t _width = 0, _height = 0;
+    float _scale = 1;
+    size_t numTilesX = 0, numTilesY = 0;
+    std::vector<uint8_t> _pixels;
+    /// Triangle indices binned per tile. Reused across frames
+    std::vector<std::vector<uint32_t>> bins;
+};
+
+} // namespace xui
+
+#endif // AETHER_SOFTWARERENDERER_H
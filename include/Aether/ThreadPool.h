@@ -0,0 +1,69 @@
+#ifndef AETHER_THREADPOOL_H
+#define AETHER_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <utl/function_view.hpp>
+
+namespace xui {
+
+/// Persistent worker threads for parallel loops that run every frame, e.g.,
+/// parallel recording in `DrawingContext` and tile rasterization in
+/// `SoftwareRenderer`. Threads are started once and sleep between calls to
+/// `run()`, so a frame does not pay for creating threads
+class ThreadPool {
+public:
+    /// Creates a pool that runs work on \p numThreads threads including the
+    /// thread that calls `run()`. If \p numThreads is zero, one thread per
+    /// hardware thread is used
+    explicit ThreadPool(size_t numThreads = 0);
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    /// Stops and joins the worker threads
+    ~ThreadPool();
+
+    /// Number of threads that `run()` uses at most, including the calling
+    /// thread
+    size_t numThreads() const { return workers.size() + 1; }
+
+    /// Invokes \p fn once on each of \p numInvocations threads, one of them
+    /// the calling thread, and returns after all invocations returned.
+    /// At most `numThreads()` invocations are made. \p fn is meant to pull
+    /// work items from a shared counter until none are left, because it is
+    /// invoked only once if `run()` is called from a worker thread.
+    /// Concurrent calls from different threads are serialized
+    void run(size_t numInvocations, utl::function_view<void()> fn);
+
+    /// Pool with one thread per hardware thread shared by all users in the
+    /// process
+    static ThreadPool& shared();
+
+private:
+    void workerMain(size_t index);
+
+    std::vector<std::thread> workers;
+    /// Serializes calls to `run()`
+    std::mutex runMutex;
+    /// Guards the members below
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    utl::function_view<void()>* job = nullptr;
+    /// Incremented for every job so workers can tell new jobs apart
+    size_t generation = 0;
+    /// Workers with an index below this take part in the current job
+    size_t numJobWorkers = 0;
+    /// Workers that have not finished the current job
+    size_t numPending = 0;
+    bool stopping = false;
+};
+
+} // namespace xui
+
+#endif // AETHER_THREADPOOL_H
@@ -137,6 +137,13 @@ constexpr Vec<T, N> operator+(Vec<T, N> const& a, Vec<T, N> const& b) {
     }(std::make_index_sequence<N>());
 }
 
+template <typename T, size_t N>
+constexpr bool operator==(Vec<T, N> const& a, Vec<T, N> const& b) {
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return ((a.data[I] == b.data[I]) && ...);
+    }(std::make_index_sequence<N>());
+}
+
 template <typename T, size_t N>
 constexpr Vec<T, N> operator-(Vec<T, N> const& a, Vec<T, N> const& b) {
     return [&]<size_t... I>(std::index_sequence<I...>) {
@@ -289,6 +296,10 @@ struct Rect: Point, Size {
     Size const& size() const { return *this; };
 };
 
+constexpr bool operator==(Rect const& A, Rect const& B) {
+    return A.origin() == B.origin() && A.size() == B.size();
+}
+
 inline Rect normalize(Rect rect) {
     if (rect.width() < 0) {
         rect.width() = -rect.width();
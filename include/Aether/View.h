@@ -1,14 +1,14 @@
 #ifndef AETHER_VIEW_H
 #define AETHER_VIEW_H
 
-#include <any>
+#include <array>
+#include <cstdint>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <ranges>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include <utl/function_view.hpp>
@@ -86,16 +86,22 @@ public:
     Size minSize() const { return _minSize; }
     double minWidth() const { return _minSize.width(); }
     double minHeight() const { return _minSize.height(); }
-    void setMinSize(Size value) { _minSize = value; }
-    void setMinWidth(double value) { _minSize.width() = value; }
-    void setMinHeight(double value) { _minSize.height() = value; }
+    void setMinSize(Size value) {
+        _minSize = value;
+        setNeedsLayout();
+    }
+    void setMinWidth(double value) { setMinSize({ value, minHeight() }); }
+    void setMinHeight(double value) { setMinSize({ minWidth(), value }); }
 
     Size maxSize() const { return _maxSize; }
     double maxWidth() const { return _maxSize.width(); }
     double maxHeight() const { return _maxSize.height(); }
-    void setMaxSize(Size value) { _maxSize = value; }
-    void setMaxWidth(double value) { _maxSize.width() = value; }
-    void setMaxHeight(double value) { _maxSize.height() = value; }
+    void setMaxSize(Size value) {
+        _maxSize = value;
+        setNeedsLayout();
+    }
+    void setMaxWidth(double value) { setMaxSize({ value, maxHeight() }); }
+    void setMaxHeight(double value) { setMaxSize({ maxWidth(), value }); }
 
     double preferredWidth() const {
         return detail::doubleValOr(_prefSize.width(), minWidth());
@@ -109,23 +115,49 @@ public:
 
     void setPreferredWidth(std::optional<double> value) {
         _prefSize.width() = detail::valOrNan(value);
+        setNeedsLayout();
     }
     void setPreferredHeight(std::optional<double> value) {
         _prefSize.height() = detail::valOrNan(value);
+        setNeedsLayout();
     }
     void setPreferredSize(Vec2<std::optional<double>> value) {
         setPreferredWidth(value.x);
         setPreferredHeight(value.y);
     }
 
+    /// Lays out this view and its subviews in \p frame. Does nothing if the
+    /// view has not been invalidated since it was last laid out in the same
+    /// frame
     void layout(Rect frame);
 
+    /// Marks this view and all of its ancestors as requiring layout. Setters
+    /// that affect layout call this automatically
+    void setNeedsLayout();
+
+    /// \Returns `true` if the next call to `layout()` must lay out this view
+    /// even if its frame did not change
+    bool needsLayout() const { return _needsLayout; }
+
+    /// \Returns the size this view takes if its parent proposes \p proposal.
+    /// An infinite component asks for the ideal size along that axis and a
+    /// zero component for the minimum size. Results are cached per proposal
+    /// until the view is invalidated by `setNeedsLayout()`
+    Size measure(Size proposal) const;
+
     void* nativeHandle() const { return _nativeHandle; }
 
     Vec2<LayoutMode> layoutMode() const { return _layoutMode; }
-    void setLayoutMode(Vec2<LayoutMode> mode) { _layoutMode = mode; }
-    void setLayoutModeX(LayoutMode mode) { _layoutMode.x = mode; }
-    void setLayoutModeY(LayoutMode mode) { _layoutMode.y = mode; }
+    void setLayoutMode(Vec2<LayoutMode> mode) {
+        _layoutMode = mode;
+        setNeedsLayout();
+    }
+    void setLayoutModeX(LayoutMode mode) {
+        setLayoutMode({ mode, _layoutMode.y });
+    }
+    void setLayoutModeY(LayoutMode mode) {
+        setLayoutMode({ _layoutMode.x, mode });
+    }
 
     /// \Returns the frame of this view
     Rect frame() const { return { origin(), size() }; }
@@ -146,28 +178,40 @@ public:
     View const* parent() const { return _parent; }
 
     /// \Returns the value of the attribute \p key if present, otherwise
-    /// `std::nullopt` A call to this function is ill-format if \p T is not the
-    /// type of the attribute \p key
+    /// `std::nullopt`
     template <ViewAttributeKey Key>
     std::optional<detail::ViewAttribKeyType<Key>> getAttribute() const {
-        if (auto value = getAttributeImpl(Key); value.has_value()) {
-            return std::any_cast<detail::ViewAttribKeyType<Key>>(value);
+        if (auto* value = findAttribute<Key>()) {
+            return *value;
         }
         return std::nullopt;
     }
 
+    /// \Returns a pointer to the value of the attribute \p key if present,
+    /// otherwise null. Unlike `getAttribute()` this does not copy the value
+    template <ViewAttributeKey Key>
+    detail::ViewAttribKeyType<Key> const* findAttribute() const {
+        return _attributes.find<Key>();
+    }
+
     /// Sets the attribute \p key to \p value or, if \p value is an empty
     /// `std::optional<T>`, clears the attribute value
     template <ViewAttributeKey Key>
     void setAttribute(std::optional<detail::ViewAttribKeyType<Key>> value) {
-        if (value) {
-            setAttributeImpl(Key, *std::move(value));
-        }
-        else {
-            clearAttributeImpl(Key);
+        bool changed = value ? _attributes.set<Key>(*std::move(value)) :
+                               _attributes.clear<Key>();
+        if (changed && affectsLayout(Key)) {
+            setNeedsLayout();
         }
     }
 
+    /// \Returns `true` if this view may handle events of type \p type. Views
+    /// that neither install a handler for \p type nor override `onEvent()`
+    /// for it are skipped in constant time during event delivery
+    bool listensTo(EventType type) const {
+        return (_handledEvents | ~_declinedEvents) & eventTypeBit(type);
+    }
+
     /// Installs the event handler functions \p f... onto this view
     template <EventHandlerType... F>
     auto addEventHandler(F&&... f) {
@@ -235,6 +279,15 @@ protected:
     void setSubviewsWeak(detail::PrivateViewKeyT,
                          std::vector<std::unique_ptr<View>> views);
 
+    /// Appends \p view to the subviews without calling the backing API or
+    /// invalidating the layout
+    View* addSubviewWeak(detail::PrivateViewKeyT, std::unique_ptr<View> view);
+
+    /// Removes \p view from the subviews and returns it. Does not call the
+    /// backing API or invalidate the layout
+    std::unique_ptr<View> removeSubviewWeak(detail::PrivateViewKeyT,
+                                            View* view);
+
     void removeAllSubviews();
 
     /// Configures this view to be drawable
@@ -250,40 +303,97 @@ protected:
 
     void setShadow(ShadowConfig config = {});
 
+    /// \Returns the total padding along each axis, i.e., the difference
+    /// between the frame passed to `layout()` and the frame passed to
+    /// `doLayout()`
+    Size padding() const;
+
 private:
     friend class TabView; // To set _parent
 
     void installEventHandler(EventType type,
                              std::function<bool(EventUnion const&)> handler);
-    void setAttributeImpl(ViewAttributeKey key, std::any value);
-    void clearAttributeImpl(ViewAttributeKey key);
-    std::any getAttributeImpl(ViewAttributeKey key) const;
+
+    /// \Returns `true` if the attribute \p key can change the layout of a view
+    /// or of its parent
+    static constexpr bool affectsLayout(ViewAttributeKey key) {
+        return key != ViewAttributeKey::DrawingContext;
+    }
 
     virtual void doLayout(Rect frame);
 
+    /// Computes the size of the content of this view for `measure()`.
+    /// \p proposal and the result exclude padding. The default implementation
+    /// takes finite proposals along flexible axes and the preferred size
+    /// otherwise
+    virtual Size doMeasure(Size proposal) const;
+
+    /// Called by `setNeedsLayout()` for this view and its ancestors. Views that
+    /// cache layout information about their subviews discard it here
+    virtual void invalidateLayoutCache() {}
+
     virtual void draw(Rect);
 
     virtual bool clipsToBounds() const { return true; }
 
-    /// Event handler functions @{
-    virtual bool onEvent(MouseDownEvent const&) { return false; }
-    virtual bool onEvent(MouseUpEvent const&) { return false; }
-    virtual bool onEvent(MouseMoveEvent const&) { return false; }
-    virtual bool onEvent(MouseDragEvent const&) { return false; }
-    virtual bool onEvent(MouseEnterEvent const&) { return false; }
-    virtual bool onEvent(MouseExitEvent const&) { return false; }
-    virtual bool onEvent(ScrollEvent const&) { return false; }
+    /// Event handler functions. The default implementations record that the
+    /// view does not override them, so further events of that type skip the
+    /// call. Overrides that decline an event should therefore return `false`
+    /// instead of calling the base implementation @{
+    virtual bool onEvent(MouseDownEvent const&) {
+        return declineEvent(EventType::MouseDownEvent);
+    }
+    virtual bool onEvent(MouseUpEvent const&) {
+        return declineEvent(EventType::MouseUpEvent);
+    }
+    virtual bool onEvent(MouseMoveEvent const&) {
+        return declineEvent(EventType::MouseMoveEvent);
+    }
+    virtual bool onEvent(MouseDragEvent const&) {
+        return declineEvent(EventType::MouseDragEvent);
+    }
+    virtual bool onEvent(MouseEnterEvent const&) {
+        return declineEvent(EventType::MouseEnterEvent);
+    }
+    virtual bool onEvent(MouseExitEvent const&) {
+        return declineEvent(EventType::MouseExitEvent);
+    }
+    virtual bool onEvent(ScrollEvent const&) {
+        return declineEvent(EventType::ScrollEvent);
+    }
     /// @}
 
+    bool declineEvent(EventType type) {
+        _declinedEvents |= eventTypeBit(type);
+        return false;
+    }
+
     View* _parent = nullptr;
     void* _nativeHandle = nullptr;
     Vec2<LayoutMode> _layoutMode;
     Size _minSize, _maxSize, _prefSize;
     bool _ignoreMouseEvents = false;
+    bool _needsLayout = true;
+    /// The frame of the last call to `layout()`
+    Rect _layoutFrame{};
+    struct Measurement {
+        Size proposal, size;
+    };
+    /// The most recent results of `measure()`
+    mutable std::array<Measurement, 4> _measurements;
+    mutable uint8_t _numMeasurements = 0;
+    mutable uint8_t _nextMeasurement = 0;
     std::vector<std::unique_ptr<View>> _subviews;
-    std::unordered_map<ViewAttributeKey, std::any> _attribMap;
-    std::unordered_map<EventType, std::function<bool(EventUnion const&)>>
-        _eventHandlers;
+    detail::ViewAttributeStorage _attributes;
+    using EventHandlerTable =
+        std::array<std::function<bool(EventUnion const&)>, NumEventTypes>;
+    /// Handlers installed by `addEventHandler()` indexed by event type.
+    /// Allocated by the first installed handler
+    std::unique_ptr<EventHandlerTable> _eventHandlers;
+    /// Event types that have a handler in `_eventHandlers`
+    EventTypeMask _handledEvents = 0;
+    /// Event types for which `onEvent()` is not overridden
+    EventTypeMask _declinedEvents = 0;
 };
 
 class SpacerView: public View {
@@ -305,6 +415,7 @@ private:
     static void* nativeConstructor(ViewOptions const&);
 
     void doLayout(Rect frame) override;
+    Size doMeasure(Size proposal) const override;
 
     Axis axis;
 };
@@ -359,12 +470,38 @@ class ScrollView: public View {
 public:
     ScrollView(Axis axis, std::vector<std::unique_ptr<View>> children);
 
+    /// \Returns the part of the document that is visible, in document
+    /// coordinates
+    Rect visibleRect() const;
+
+    /// Scrolls the document such that \p offset is the top left corner of the
+    /// visible rect
+    void scrollTo(Point offset);
+
+    struct Impl;
+
+protected:
+    Axis scrollAxis() const { return axis; }
+
+    bool setFrame(Rect frame) override;
+
+    void setDocumentSize(Size size);
+
+    /// Adds \p view to the document without invalidating the layout
+    View* addDocumentSubview(std::unique_ptr<View> view);
+
+    /// Removes \p view from the document without invalidating the layout and
+    /// returns it
+    std::unique_ptr<View> removeDocumentSubview(View* view);
+
 private:
     static void* nativeConstructor(Axis, ViewOptions const&);
 
     void doLayout(Rect frame) override;
-    bool setFrame(Rect frame) override;
-    void setDocumentSize(Size size);
+    Size doMeasure(Size proposal) const override;
+
+    /// Called when the visible rect changes by scrolling
+    virtual void didScroll() {}
 
     friend void applyModifier(NoBackgroundT, ScrollView&);
 
@@ -385,6 +522,91 @@ std::unique_ptr<ScrollView> HScrollView(std::unique_ptr<View> (&&children)[N]) {
     return HScrollView(toMoveOnlyVector(std::move(children)));
 }
 
+/// Scroll view that only creates views for the rows that intersect the visible
+/// rect and recycles rows that are scrolled out of view
+class LazyListView: public ScrollView {
+public:
+    /// \Returns the expected size of row \p index along the scroll axis. Rows
+    /// are measured when they are created and the estimate is replaced by the
+    /// measured size
+    using SizeEstimator = std::function<double(size_t index)>;
+
+    /// \Returns the view for row \p index. \p reusable is a view of a row
+    /// that was scrolled out of view, or null. The factory may update and
+    /// return it instead of creating a new view
+    using RowFactory = std::function<std::unique_ptr<View>(
+        size_t index, std::unique_ptr<View> reusable)>;
+
+    LazyListView(Axis axis, size_t numRows, SizeEstimator estimateSize,
+                 RowFactory makeRow);
+
+    size_t numRows() const { return _numRows; }
+
+    /// Sets the number of rows and recreates all visible rows
+    void setNumRows(size_t count);
+
+    /// Recreates all visible rows and estimates all row sizes again
+    void reloadData();
+
+    /// Distance beyond the visible rect along the scroll axis in which rows
+    /// are created ahead of time
+    double overscan() const { return _overscan; }
+
+    void setOverscan(double value);
+
+    /// \Returns the number of rows that currently have a view
+    size_t numVisibleRows() const { return rows.size(); }
+
+    /// \Returns the number of row views waiting in the reuse pool
+    size_t numReusableRows() const { return reusePool.size(); }
+
+private:
+    void doLayout(Rect frame) override;
+    Size doMeasure(Size proposal) const override;
+    void didScroll() override;
+
+    /// Creates, recycles and lays out rows such that exactly the rows within
+    /// the overscanned visible rect have views
+    void updateRows();
+
+    /// \Returns the offset of row \p index along the scroll axis
+    double rowOffset(size_t index) const;
+
+    /// Recomputes stale row offsets
+    void updateOffsets() const;
+
+    void recycleRow(View* row);
+
+    std::unique_ptr<View> makeRowView(size_t index);
+
+    SizeEstimator estimateSize;
+    RowFactory makeRow;
+    size_t _numRows;
+    double _overscan = 200;
+    /// Estimated or measured row sizes and their prefix sums
+    mutable std::vector<double> rowSizes;
+    mutable std::vector<double> rowOffsets;
+    /// Offsets from this index on must be recomputed
+    mutable size_t firstStaleOffset = 0;
+    /// Views of the rows `firstRow` to `firstRow + rows.size()`
+    size_t firstRow = 0;
+    std::vector<View*> rows;
+    std::vector<View*> nextRows;
+    std::vector<std::unique_ptr<View>> reusePool;
+    /// Guards against scroll notifications while rows are updated
+    bool isUpdatingRows = false;
+};
+
+/// Vertical lazy list of \p numRows rows
+std::unique_ptr<LazyListView> VLazyList(size_t numRows,
+                                        LazyListView::SizeEstimator estimate,
+                                        LazyListView::RowFactory makeRow);
+
+/// Horizontal lazy list of \p numRows rows
+std::unique_ptr<LazyListView> HLazyList(size_t numRows,
+                                        LazyListView::SizeEstimator estimate,
+                                        LazyListView::RowFactory makeRow);
+
 class SplitView: public View {
 public:
     SplitView(Axis axis, std::vector<std::unique_ptr<View>> children);
@@ -420,7 +642,9 @@ private:
     static void* nativeConstructor(SplitView*, Axis, ViewOptions const&);
 
     void doLayout(Rect frame) override;
+    Size doMeasure(Size proposal) const override;
 
+    double dividerThickness() const;
     double sizeWithoutDividers() const;
     bool isChildCollapsed(size_t childIndex) const;
 
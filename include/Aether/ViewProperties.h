@@ -1,7 +1,10 @@
 #ifndef AETHER_VIEWPROPERTIES_H
 #define AETHER_VIEWPROPERTIES_H
 
+#include <cstdint>
 #include <memory>
+#include <tuple>
+#include <utility>
 
 #include <utl/common.hpp>
 
@@ -58,6 +61,10 @@ enum class ViewAttributeKey {
 #undef X
 };
 
+#define X(Name, Type) +1
+inline constexpr size_t NumViewAttributeKeys = 0 AETHER_VIEW_ATTRIB_KEY(X);
+#undef X
+
 namespace detail {
 
 template <ViewAttributeKey>
@@ -114,6 +121,65 @@ template <typename T>
 using ViewAttributeKeyGetter =
     ViewAttributeKeyGetterImpl<std::type_identity_t<T>>;
 
+template <typename>
+struct ViewAttribTupleImpl;
+
+template <size_t... I>
+struct ViewAttribTupleImpl<std::index_sequence<I...>> {
+    using type = std::tuple<ViewAttribKeyType<(ViewAttributeKey)I>...>;
+};
+
+/// Stores one value for each view attribute inline and a bitmask of the
+/// attributes that are set. Slots of absent attributes hold default
+/// constructed values, so the storage never allocates by itself
+class ViewAttributeStorage {
+public:
+    /// \Returns a pointer to the value of \p Key or null if it is not set
+    template <ViewAttributeKey Key>
+    ViewAttribKeyType<Key> const* find() const {
+        return has<Key>() ? &std::get<(size_t)Key>(slots) : nullptr;
+    }
+
+    template <ViewAttributeKey Key>
+    bool has() const {
+        return presence & bit(Key);
+    }
+
+    /// Sets \p Key to \p value. \Returns `true` if the stored value changed
+    template <ViewAttributeKey Key>
+    bool set(ViewAttribKeyType<Key> value) {
+        auto& slot = std::get<(size_t)Key>(slots);
+        if (has<Key>() && slot == value) {
+            return false;
+        }
+        slot = std::move(value);
+        presence |= bit(Key);
+        return true;
+    }
+
+    /// Clears \p Key. \Returns `true` if it was set
+    template <ViewAttributeKey Key>
+    bool clear() {
+        if (!has<Key>()) {
+            return false;
+        }
+        std::get<(size_t)Key>(slots) = {};
+        presence &= ~bit(Key);
+        return true;
+    }
+
+private:
+    static_assert(NumViewAttributeKeys <= 32);
+
+    static constexpr uint32_t bit(ViewAttributeKey key) {
+        return uint32_t(1) << (size_t)key;
+    }
+
+    typename ViewAttribTupleImpl<
+        std::make_index_sequence<NumViewAttributeKeys>>::type slots;
+    uint32_t presence = 0;
+};
+
 } // namespace detail
 
 } // namespace xui
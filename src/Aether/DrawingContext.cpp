@@ -1,8 +1,104 @@
 #include "Aether/DrawingContext.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+#include <csp.hpp>
+
+#include "Aether/FrameCapture.h"
+#include "Aether/ThreadPool.h"
+
 using namespace xui;
 using namespace vml::short_types;
 
+Transform2D Transform2D::Rotation(float angle) {
+    float c = std::cos(angle), s = std::sin(angle);
+    return { { c, s }, { -s, c }, { 0, 0 } };
+}
+
+Transform2D Transform2D::inverse() const {
+    float det = determinant();
+    assert(det != 0 && "Transform is not invertible");
+    vml::float2 c0 = vml::float2{ column1.y, -column0.y } / det;
+    vml::float2 c1 = vml::float2{ -column1.x, column0.x } / det;
+    return { c0, c1, -(translation.x * c0 + translation.y * c1) };
+}
+
+Transform2D xui::operator*(Transform2D const& A, Transform2D const& B) {
+    return { A(B.column0) - A.translation, A(B.column1) - A.translation,
+             A(B.translation) };
+}
+
+/// \Returns the bounding box of \p rect transformed by \p transform.
+/// Unbounded rectangles stay unbounded
+static ClipRect transformBounds(Transform2D const& transform,
+                                ClipRect const& rect) {
+    if (!std::isfinite(rect.min.x) || !std::isfinite(rect.min.y) ||
+        !std::isfinite(rect.max.x) || !std::isfinite(rect.max.y))
+    {
+        return {};
+    }
+    vml::float2 corners[] = { transform(rect.min),
+                              transform({ rect.max.x, rect.min.y }),
+                              transform(rect.max),
+                              transform({ rect.min.x, rect.max.y }) };
+    ClipRect result = { corners[0], corners[0] };
+    for (auto p: corners) {
+        result.min = { std::min(result.min.x, p.x),
+                       std::min(result.min.y, p.y) };
+        result.max = { std::max(result.max.x, p.x),
+                       std::max(result.max.y, p.y) };
+    }
+    return result;
+}
+
+static ClipRect intersect(ClipRect const& a, ClipRect const& b) {
+    return { { std::max(a.min.x, b.min.x), std::max(a.min.y, b.min.y) },
+             { std::min(a.max.x, b.max.x), std::min(a.max.y, b.max.y) } };
+}
+
+static bool equal(Color const& a, Color const& b) {
+    return std::equal(std::begin(a.data), std::end(a.data), std::begin(b.data));
+}
+
+static bool equal(vml::float2 a, vml::float2 b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+static bool equal(Transform2D const& a, Transform2D const& b) {
+    return equal(a.column0, b.column0) && equal(a.column1, b.column1) &&
+           equal(a.translation, b.translation);
+}
+
+static bool equal(ClipRect const& a, ClipRect const& b) {
+    return equal(a.min, b.min) && equal(a.max, b.max);
+}
+
+static bool equal(FillMode const& a, FillMode const& b) {
+    if (a.index() != b.index()) {
+        return false;
+    }
+    // clang-format off
+    return std::visit(csp::overload{
+        [&](FlatColor const& c) {
+            return equal(c.color, std::get<FlatColor>(b).color);
+        },
+        [&](Gradient const& g) {
+            auto& h = std::get<Gradient>(b);
+            return equal(g.begin.coord, h.begin.coord) &&
+                   equal(g.begin.color, h.begin.color) &&
+                   equal(g.end.coord, h.end.coord) &&
+                   equal(g.end.color, h.end.color);
+        },
+    }, a); // clang-format on
+}
+
 void DrawingContext::addDrawCall(DrawCall dc) {
     if (dc.beginVertex == dc.endVertex || dc.beginIndex == dc.endIndex) {
         return;
@@ -10,28 +106,633 @@ void DrawingContext::addDrawCall(DrawCall dc) {
     drawCalls.push_back(dc);
 }
 
+/// Copies the points of \p points that differ from their predecessor to
+/// \p out. If \p closed is true, trailing points that are equal to the first
+/// point are also skipped. \Returns the number of points written
+static size_t copyWithoutRepeats(std::span<vml::float2 const> points,
+                                 std::span<vml::float2> out, bool closed) {
+    size_t count = 0;
+    for (auto p: points) {
+        if (count == 0 || !equal(p, out[count - 1])) {
+            out[count++] = p;
+        }
+    }
+    while (closed && count > 1 && equal(out[count - 1], out[0])) {
+        --count;
+    }
+    return count;
+}
+
 void DrawingContext::addLine(std::span<vml::float2 const> points,
                              DrawCallOptions const& drawOptions,
                              LineMeshOptions const& meshOptions) {
+    // Repeated points would produce segments without direction
+    std::pmr::vector<vml::float2> welded(&_frameArena);
+    if (drawOptions.weldVertices) {
+        welded.resize(points.size());
+        welded.resize(
+            copyWithoutRepeats(points, welded, meshOptions.closed));
+        points = welded;
+    }
+    LineMeshOptions options = meshOptions;
+    if (!options.scratch) {
+        options.scratch = &_frameArena;
+    }
     recordDrawCall(drawOptions, [&] {
-        buildLineMesh(points, vertexEmitter(), triangleEmitter(), meshOptions);
+        auto size = lineMeshSize(points, options);
+        auto [vertexBuffer, indexBuffer] = allocate(size);
+        auto written =
+            buildLineMeshInto(points, vertexBuffer, indexBuffer, options);
+        shrink(size, written);
+        if (drawOptions.weldVertices) {
+            weldCurrentMesh();
+        }
+        addAntialiasingFringe(drawOptions.fringeWidth);
     });
 }
 
+/// Parameters of the mesh cache key of a triangulated polygon
+static std::array<uint32_t, 5> polygonKeyParams(
+    bool multipleContours, DrawCallOptions const& drawOptions,
+    TriangulationOptions const& options) {
+    return { multipleContours, options.isYMonotone,
+             (uint32_t)options.orientation, (uint32_t)options.fillRule,
+             std::bit_cast<uint32_t>(drawOptions.fringeWidth) };
+}
+
 void DrawingContext::addPolygon(std::span<vml::float2 const> points,
                                 DrawCallOptions const& drawOptions,
                                 TriangulationOptions const& meshOptions) {
+    TriangulationOptions options = meshOptions;
+    if (!options.scratch) {
+        options.scratch = &_frameArena;
+    }
     recordDrawCall(drawOptions, [&] {
-        std::ranges::copy(points, std::back_inserter(vertices));
-        triangulatePolygon(points, triangleEmitter(), meshOptions);
+        MeshKey key(points, polygonKeyParams(false, drawOptions, options),
+                    &_frameArena);
+        if (addCachedMesh(key)) {
+            return;
+        }
+        MeshSize size = { points.size(), polygonIndexCount(points.size()) };
+        auto [vertexBuffer, indexBuffer] = allocate(size);
+        std::ranges::copy(points, vertexBuffer.begin());
+        size_t numIndices =
+            triangulatePolygonInto(vertexBuffer, indexBuffer, options);
+        shrink(size, { points.size(), numIndices });
+        addAntialiasingFringe(drawOptions.fringeWidth);
+        cacheCurrentMesh(key);
     });
 }
 
+void DrawingContext::addPolygon(
+    std::span<std::span<vml::float2 const> const> contours,
+    DrawCallOptions const& drawOptions,
+    TriangulationOptions const& meshOptions) {
+    TriangulationOptions options = meshOptions;
+    if (!options.scratch) {
+        options.scratch = &_frameArena;
+    }
+    recordDrawCall(drawOptions, [&] {
+        MeshKey key(contours, polygonKeyParams(true, drawOptions, options),
+                    &_frameArena);
+        if (addCachedMesh(key)) {
+            return;
+        }
+        size_t numVertices = 0;
+        for (auto contour: contours) {
+            numVertices += contour.size();
+        }
+        MeshSize size = { numVertices,
+                          polygonIndexCount(numVertices, contours.size()) };
+        auto [vertexBuffer, indexBuffer] = allocate(size);
+        auto out = vertexBuffer.begin();
+        for (auto contour: contours) {
+            out = std::ranges::copy(contour, out).out;
+        }
+        size_t numIndices =
+            triangulatePolygonInto(contours, indexBuffer, options);
+        shrink(size, { numVertices, numIndices });
+        addAntialiasingFringe(drawOptions.fringeWidth);
+        cacheCurrentMesh(key);
+    });
+}
+
+void DrawingContext::weldCurrentMesh() {
+    auto welded =
+        weldVertices(std::span(vertices).subspan(currentDC.beginVertex),
+                     std::span(indices).subspan(currentDC.beginIndex),
+                     &_frameArena);
+    shrink({ vertices.size() - currentDC.beginVertex,
+             indices.size() - currentDC.beginIndex },
+           welded);
+}
+
+void DrawingContext::addAntialiasingFringe(float width) {
+    if (!(width > 0)) {
+        return;
+    }
+    // The fringe is built into separate buffers because it reads the mesh
+    std::pmr::vector<vml::float2> fringeVertices(&_frameArena);
+    std::pmr::vector<uint32_t> fringeIndices(&_frameArena);
+    auto emitVertex = [&](vml::float2 p) { fringeVertices.push_back(p); };
+    auto emitTriangle = [&](uint32_t a, uint32_t b, uint32_t c) {
+        fringeIndices.insert(fringeIndices.end(), { a, b, c });
+    };
+    buildAntialiasingFringe(std::span(vertices).subspan(currentDC.beginVertex),
+                            std::span(indices).subspan(currentDC.beginIndex),
+                            emitVertex, emitTriangle, width, &_frameArena);
+    vertices.insert(vertices.end(), fringeVertices.begin(),
+                    fringeVertices.end());
+    coverage.resize(vertices.size(), 0.0f);
+    paintIndices.resize(vertices.size(), currentPaint);
+    indices.insert(indices.end(), fringeIndices.begin(), fringeIndices.end());
+}
+
+bool DrawingContext::addCachedMesh(MeshKey const& key) {
+    auto* mesh = meshCache.find(key);
+    if (!mesh) {
+        return false;
+    }
+    auto [vertexBuffer, indexBuffer] =
+        allocate({ mesh->vertices.size(), mesh->indices.size() });
+    std::ranges::transform(mesh->vertices, vertexBuffer.begin(),
+                           [origin = key.origin()](vml::float2 v) {
+        return v + origin;
+    });
+    std::ranges::copy(mesh->coverage,
+                      coverage.end() - (std::ptrdiff_t)mesh->coverage.size());
+    std::ranges::copy(mesh->indices, indexBuffer.begin());
+    return true;
+}
+
+void DrawingContext::cacheCurrentMesh(MeshKey const& key) {
+    meshCache.insert(key,
+                     std::span(vertices).subspan(currentDC.beginVertex),
+                     std::span(coverage).subspan(currentDC.beginVertex),
+                     std::span(indices).subspan(currentDC.beginIndex));
+}
+
+std::pair<std::span<vml::float2>, std::span<uint32_t>> DrawingContext::
+    allocate(MeshSize size) {
+    size_t beginVertex = vertices.size();
+    size_t beginIndex = indices.size();
+    vertices.resize(beginVertex + size.numVertices);
+    coverage.resize(beginVertex + size.numVertices, 1.0f);
+    paintIndices.resize(beginVertex + size.numVertices, currentPaint);
+    indices.resize(beginIndex + size.numIndices);
+    return { std::span(vertices).subspan(beginVertex),
+             std::span(indices).subspan(beginIndex) };
+}
+
+void DrawingContext::shrink(MeshSize allocated, MeshSize used) {
+    assert(used.numVertices <= allocated.numVertices);
+    assert(used.numIndices <= allocated.numIndices);
+    vertices.resize(vertices.size() - allocated.numVertices +
+                    used.numVertices);
+    coverage.resize(vertices.size());
+    paintIndices.resize(vertices.size());
+    indices.resize(indices.size() - allocated.numIndices + used.numIndices);
+}
+
+void DrawingContext::setFill(FillMode const& fill) {
+    // Shapes with the same fill are usually drawn in sequence, so comparing
+    // with the last paint avoids most duplicates
+    if (paints.empty() || !equal(paints.back(), fill)) {
+        paints.push_back(fill);
+    }
+    currentPaint = (uint32_t)(paints.size() - 1);
+}
+
+void DrawingContext::pushTransform(Transform2D const& transform) {
+    transformStack.push_back(currentTransform);
+    currentTransform = currentTransform * transform;
+}
+
+void DrawingContext::popTransform() {
+    assert(!transformStack.empty());
+    currentTransform = transformStack.back();
+    transformStack.pop_back();
+}
+
+void DrawingContext::pushClipRect(vml::float2 min, vml::float2 max) {
+    clipRectStack.push_back(currentClipRect);
+    currentClipRect =
+        intersect(currentClipRect,
+                  transformBounds(currentTransform, { min, max }));
+}
+
+void DrawingContext::popClipRect() {
+    assert(!clipRectStack.empty());
+    currentClipRect = clipRectStack.back();
+    clipRectStack.pop_back();
+}
+
+void DrawingContext::batchDrawCalls() {
+    if (drawCalls.empty()) {
+        return;
+    }
+    auto out = drawCalls.begin();
+    for (auto in = std::next(out); in != drawCalls.end(); ++in) {
+        // Draw calls are recorded back to back, but the vertices of skipped
+        // empty draw calls may lie in between. Fills are per vertex and do not
+        // prevent merging. Runs are not grown beyond the vertices that 16 bit
+        // indices can address unless they already exceed them
+        bool fitsShortIndices =
+            in->endVertex - out->beginVertex <= MaxShortIndexVertices ||
+            out->endVertex - out->beginVertex > MaxShortIndexVertices;
+        bool mergeable = out->endIndex == in->beginIndex &&
+                         out->endVertex <= in->beginVertex &&
+                         !out->instanced() && !in->instanced() &&
+                         out->options.wireframe == in->options.wireframe &&
+                         equal(out->transform, in->transform) &&
+                         equal(out->clipRect, in->clipRect) && fitsShortIndices;
+        if (!mergeable) {
+            *++out = *in;
+            continue;
+        }
+        auto offset = (uint32_t)(in->beginVertex - out->beginVertex);
+        for (size_t i = in->beginIndex; i < in->endIndex; ++i) {
+            indices[i] += offset;
+        }
+        out->endVertex = in->endVertex;
+        out->endIndex = in->endIndex;
+    }
+    drawCalls.erase(std::next(out), drawCalls.end());
+}
+
+void DrawingContext::packIndices() {
+    shortIndices.clear();
+    size_t numIndices = 0;
+    for (auto& dc: drawCalls) {
+        auto begin = indices.begin() + (ptrdiff_t)dc.beginIndex;
+        auto end = indices.begin() + (ptrdiff_t)dc.endIndex;
+        if (dc.endVertex - dc.beginVertex <= MaxShortIndexVertices) {
+            dc.indexType = IndexType::UInt16;
+            // GPU APIs require index buffer offsets to be aligned to 4 bytes
+            if (shortIndices.size() % 2 != 0) {
+                shortIndices.push_back(0);
+            }
+            dc.beginIndex = shortIndices.size();
+            shortIndices.insert(shortIndices.end(), begin, end);
+            dc.endIndex = shortIndices.size();
+        }
+        else {
+            // Draw calls are in order, so this never overwrites indices that
+            // are still to be read
+            dc.indexType = IndexType::UInt32;
+            size_t size = dc.endIndex - dc.beginIndex;
+            std::copy(begin, end, indices.begin() + (ptrdiff_t)numIndices);
+            dc.beginIndex = numIndices;
+            numIndices += size;
+            dc.endIndex = numIndices;
+        }
+    }
+    indices.resize(numIndices);
+}
+
+bool DrawingContext::replayItem(uint64_t key, uint64_t version) {
+    auto itr = items.find(key);
+    if (itr == items.end() || itr->second.version != version) {
+        return false;
+    }
+    auto& item = itr->second;
+    item.used = true;
+    ++frameStats.numReusedItems;
+    appendGeometry(item.geometry);
+    return true;
+}
+
+DrawingContext::ItemRecording DrawingContext::beginItem() {
+    ItemRecording recording = { vertices.size(),  indices.size(),
+                                drawCalls.size(), instances.size(),
+                                currentTransform, currentClipRect };
+    currentTransform = {};
+    currentClipRect = {};
+    return recording;
+}
+
+void DrawingContext::endItem(uint64_t key, uint64_t version,
+                             ItemRecording const& recording) {
+    ++frameStats.numRebuiltItems;
+    auto& item = items[key];
+    item.version = version;
+    item.used = true;
+    item.geometry = captureGeometry(recording);
+    currentTransform = recording.transform;
+    currentClipRect = recording.clipRect;
+    for (size_t i = recording.beginDrawCall; i < drawCalls.size(); ++i) {
+        drawCalls[i] = placeItemDrawCall(drawCalls[i]);
+    }
+}
+
+MeshID DrawingContext::endMesh(ItemRecording const& recording) {
+    auto id = MeshID{ nextMeshID++ };
+    auto& mesh = meshes[id];
+    mesh = captureGeometry(recording);
+    assert(mesh.instances.empty() && "Meshes cannot contain instances");
+    vertices.resize(recording.beginVertex);
+    coverage.resize(recording.beginVertex);
+    paintIndices.resize(recording.beginVertex);
+    indices.resize(recording.beginIndex);
+    drawCalls.resize(recording.beginDrawCall);
+    currentTransform = recording.transform;
+    currentClipRect = recording.clipRect;
+    return id;
+}
+
+void DrawingContext::releaseMesh(MeshID mesh) { meshes.erase(mesh); }
+
+void DrawingContext::addInstances(MeshID mesh,
+                                  std::span<Instance const> instances) {
+    auto itr = meshes.find(mesh);
+    assert(itr != meshes.end() && "Mesh is not registered");
+    if (itr == meshes.end() || instances.empty()) {
+        return;
+    }
+    appendGeometry(itr->second, instances);
+}
+
+DrawingContext::RecordedGeometry DrawingContext::captureGeometry(
+    ItemRecording const& recording) {
+    auto [beginVertex, beginIndex, beginDrawCall, beginInstance, transform,
+          clipRect] = recording;
+    RecordedGeometry geometry;
+    geometry.vertices.assign(vertices.begin() + (ptrdiff_t)beginVertex,
+                             vertices.end());
+    geometry.coverage.assign(coverage.begin() + (ptrdiff_t)beginVertex,
+                             coverage.end());
+    geometry.indices.assign(indices.begin() + (ptrdiff_t)beginIndex,
+                            indices.end());
+    geometry.instances.assign(instances.begin() + (ptrdiff_t)beginInstance,
+                              instances.end());
+    // Geometry uses few paints, so a linear search maps them to local indices
+    std::pmr::vector<uint32_t> framePaints(&_frameArena);
+    for (size_t i = beginVertex; i < vertices.size(); ++i) {
+        auto itr = std::ranges::find(framePaints, paintIndices[i]);
+        if (itr == framePaints.end()) {
+            framePaints.push_back(paintIndices[i]);
+            geometry.paints.push_back(paints[paintIndices[i]]);
+            itr = std::prev(framePaints.end());
+        }
+        geometry.paintIndices.push_back((uint32_t)(itr - framePaints.begin()));
+    }
+    for (size_t i = beginDrawCall; i < drawCalls.size(); ++i) {
+        auto dc = drawCalls[i];
+        dc.beginVertex -= beginVertex;
+        dc.endVertex -= beginVertex;
+        dc.beginIndex -= beginIndex;
+        dc.endIndex -= beginIndex;
+        if (dc.instanced()) {
+            dc.beginInstance -= beginInstance;
+            dc.endInstance -= beginInstance;
+        }
+        geometry.drawCalls.push_back(dc);
+    }
+    return geometry;
+}
+
+void DrawingContext::appendGeometry(RecordedGeometry const& geometry,
+                                    std::span<Instance const> instances) {
+    // Paint indices of the frame differ from those of the frame the geometry
+    // was recorded in
+    std::pmr::vector<uint32_t> paintMap(&_frameArena);
+    paintMap.reserve(geometry.paints.size());
+    for (auto& paint: geometry.paints) {
+        setFill(paint);
+        paintMap.push_back(currentPaint);
+    }
+    size_t beginVertex = vertices.size();
+    size_t beginIndex = indices.size();
+    size_t beginInstance = this->instances.size();
+    auto [vertexBuffer, indexBuffer] =
+        allocate({ geometry.vertices.size(), geometry.indices.size() });
+    std::ranges::copy(geometry.vertices, vertexBuffer.begin());
+    std::ranges::copy(geometry.coverage,
+                      coverage.begin() + (ptrdiff_t)beginVertex);
+    std::ranges::transform(geometry.paintIndices,
+                           paintIndices.begin() + (ptrdiff_t)beginVertex,
+                           [&](uint32_t index) { return paintMap[index]; });
+    std::ranges::copy(geometry.indices, indexBuffer.begin());
+    this->instances.insert(this->instances.end(), geometry.instances.begin(),
+                           geometry.instances.end());
+    this->instances.insert(this->instances.end(), instances.begin(),
+                           instances.end());
+    for (auto dc: geometry.drawCalls) {
+        dc.beginVertex += beginVertex;
+        dc.endVertex += beginVertex;
+        dc.beginIndex += beginIndex;
+        dc.endIndex += beginIndex;
+        if (!instances.empty()) {
+            dc.beginInstance = beginInstance + geometry.instances.size();
+            dc.endInstance = dc.beginInstance + instances.size();
+        }
+        else if (dc.instanced()) {
+            dc.beginInstance += beginInstance;
+            dc.endInstance += beginInstance;
+        }
+        addDrawCall(placeItemDrawCall(dc));
+    }
+}
+
+DrawCall DrawingContext::placeItemDrawCall(DrawCall dc) const {
+    dc.clipRect = intersect(currentClipRect,
+                            transformBounds(currentTransform, dc.clipRect));
+    dc.transform = currentTransform * dc.transform;
+    return dc;
+}
+
+/// \Returns the range of elements of \p current that differ from \p previous.
+/// Elements are compared bitwise
+template <typename T>
+static DirtyRange diffRange(std::vector<T> const& previous,
+                            std::vector<T> const& current) {
+    auto differs = [&](size_t i) {
+        return std::memcmp(&previous[i], &current[i], sizeof(T)) != 0;
+    };
+    size_t common = std::min(previous.size(), current.size());
+    size_t begin = 0;
+    while (begin < common && !differs(begin)) {
+        ++begin;
+    }
+    size_t end = current.size() > common ? current.size() : common;
+    while (end > begin && end <= common && !differs(end - 1)) {
+        --end;
+    }
+    return { begin, end };
+}
+
+/// \Returns the smallest range that contains \p a and \p b
+static DirtyRange unite(DirtyRange a, DirtyRange b) {
+    if (a.begin == a.end) {
+        return b;
+    }
+    if (b.begin == b.end) {
+        return a;
+    }
+    return { std::min(a.begin, b.begin), std::max(a.end, b.end) };
+}
+
+DrawingContext::DrawingContext(View* view, RendererOptions const& options):
+    renderer(createRenderer(view, options)) {}
+
+DrawingContext::DrawingContext(ShardTag): isShard(true) {}
+
+DrawingContext::~DrawingContext() = default;
+
+bool DrawingContext::startCapture(std::filesystem::path const& path) {
+    capture = std::make_unique<FrameCaptureWriter>(path);
+    if (!capture->isOpen()) {
+        capture.reset();
+        return false;
+    }
+    return true;
+}
+
+void DrawingContext::stopCapture() { capture.reset(); }
+
 void DrawingContext::draw() {
+    frameStats.numRecordedDrawCalls = drawCalls.size();
+    batchDrawCalls();
+    frameStats.numSubmittedDrawCalls = drawCalls.size();
+    packIndices();
+    DrawData data = { .vertices = vertices,
+                      .coverage = coverage,
+                      .paintIndices = paintIndices,
+                      .paints = paints,
+                      .indices = indices,
+                      .shortIndices = shortIndices,
+                      .drawCalls = drawCalls,
+                      .instances = instances };
+    data.dirtyVertices =
+        unite(unite(diffRange(previousVertices, vertices),
+                    diffRange(previousCoverage, coverage)),
+              diffRange(previousPaintIndices, paintIndices));
+    data.dirtyIndices = diffRange(previousIndices, indices);
+    data.dirtyShortIndices = diffRange(previousShortIndices, shortIndices);
+    frameStats.numDirtyVertices =
+        data.dirtyVertices.end - data.dirtyVertices.begin;
+    frameStats.numDirtyIndices =
+        data.dirtyIndices.end - data.dirtyIndices.begin +
+        data.dirtyShortIndices.end - data.dirtyShortIndices.begin;
+    if (capture) {
+        capture->write(data);
+    }
     if (renderer) {
-        renderer->render(vertices, indices, drawCalls);
+        renderer->render(data);
+    }
+    frameStats.numScratchBytes = _frameArena.bytesUsed();
+    for (auto& shard: shards) {
+        frameStats.numScratchBytes += shard->_frameArena.bytesUsed();
     }
+    stats = std::exchange(frameStats, {});
+    // The buffers of this frame become the reference of the next frame
+    std::swap(vertices, previousVertices);
+    std::swap(coverage, previousCoverage);
+    std::swap(paintIndices, previousPaintIndices);
+    std::swap(indices, previousIndices);
+    std::swap(shortIndices, previousShortIndices);
+    endFrame();
+    for (auto& shard: shards) {
+        shard->endFrame();
+    }
+}
+
+void DrawingContext::clearFrame() {
     vertices.clear();
+    coverage.clear();
+    paintIndices.clear();
+    paints.clear();
     indices.clear();
+    shortIndices.clear();
     drawCalls.clear();
+    instances.clear();
+}
+
+void DrawingContext::endFrame() {
+    clearFrame();
+    meshCache.collect();
+    _frameArena.reset();
+    std::erase_if(items, [](auto& entry) { return !entry.second.used; });
+    for (auto& [key, item]: items) {
+        item.used = false;
+    }
+}
+
+/// Number of shards per recording thread. More shards than threads balance the
+/// load if some indices take longer to record than others
+static constexpr size_t ShardsPerThread = 4;
+
+void DrawingContext::recordParallel(
+    size_t count, utl::function_view<void(DrawingContext&, size_t)> fn) {
+    assert(!isShard && "Shards cannot record in parallel");
+    if (count == 0) {
+        return;
+    }
+    auto& pool = ThreadPool::shared();
+    size_t numThreads = numRecordingThreads;
+    if (numThreads == 0) {
+        numThreads = pool.numThreads();
+    }
+    size_t numShards = std::min(count, ShardsPerThread * numThreads);
+    while (shards.size() < numShards) {
+        shards.push_back(
+            std::unique_ptr<DrawingContext>(new DrawingContext(ShardTag{})));
+    }
+    for (size_t i = 0; i < numShards; ++i) {
+        shards[i]->currentTransform = currentTransform;
+        shards[i]->currentClipRect = currentClipRect;
+    }
+    std::atomic<size_t> nextShard = 0;
+    auto worker = [&] {
+        for (size_t s; (s = nextShard++) < numShards;) {
+            size_t end = (s + 1) * count / numShards;
+            for (size_t i = s * count / numShards; i < end; ++i) {
+                fn(*shards[s], i);
+            }
+        }
+    };
+    pool.run(std::min(numThreads, numShards), worker);
+    for (size_t s = 0; s < numShards; ++s) {
+        mergeShard(*shards[s]);
+    }
+}
+
+void DrawingContext::mergeShard(DrawingContext& shard) {
+    // Paint indices of the shard index into its own paint table
+    std::pmr::vector<uint32_t> paintMap(&_frameArena);
+    paintMap.reserve(shard.paints.size());
+    for (auto& paint: shard.paints) {
+        setFill(paint);
+        paintMap.push_back(currentPaint);
+    }
+    size_t beginVertex = vertices.size();
+    size_t beginIndex = indices.size();
+    size_t beginInstance = instances.size();
+    vertices.insert(vertices.end(), shard.vertices.begin(),
+                    shard.vertices.end());
+    coverage.insert(coverage.end(), shard.coverage.begin(),
+                    shard.coverage.end());
+    std::ranges::transform(shard.paintIndices,
+                           std::back_inserter(paintIndices),
+                           [&](uint32_t index) { return paintMap[index]; });
+    // Indices are relative to the first vertex of their draw call, so only
+    // the ranges of the draw calls are rebased
+    indices.insert(indices.end(), shard.indices.begin(), shard.indices.end());
+    instances.insert(instances.end(), shard.instances.begin(),
+                     shard.instances.end());
+    for (auto dc: shard.drawCalls) {
+        dc.beginVertex += beginVertex;
+        dc.endVertex += beginVertex;
+        dc.beginIndex += beginIndex;
+        dc.endIndex += beginIndex;
+        if (dc.instanced()) {
+            dc.beginInstance += beginInstance;
+            dc.endInstance += beginInstance;
+        }
+        drawCalls.push_back(dc);
+    }
+    frameStats.numReusedItems += shard.frameStats.numReusedItems;
+    frameStats.numRebuiltItems += shard.frameStats.numRebuiltItems;
+    shard.frameStats = {};
+    shard.clearFrame();
 }
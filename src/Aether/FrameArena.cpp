@@ -0,0 +1,78 @@
+#include "Aether/FrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+using namespace xui;
+
+FrameArena::FrameArena(size_t initialSize):
+    nextBlockSize(std::max<size_t>(initialSize, 1)) {}
+
+FrameArena::~FrameArena() = default;
+
+void FrameArena::reset() {
+    if (blocks.size() > 1) {
+        // The frame did not fit into one block, so the next frame gets a
+        // single block that fits all of it
+        size_t size = capacity();
+        blocks.clear();
+        used = 0;
+        nextBlockSize = size;
+        addBlock(size);
+    }
+    top = blockBegin();
+}
+
+size_t FrameArena::capacity() const {
+    size_t result = 0;
+    for (auto& block: blocks) {
+        result += block.size;
+    }
+    return result;
+}
+
+void FrameArena::addBlock(size_t size) {
+    if (!blocks.empty()) {
+        used += (size_t)(top - blockBegin());
+    }
+    size = std::max(size, nextBlockSize);
+    blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(size),
+                       size });
+    ++_numHeapAllocations;
+    nextBlockSize = 2 * size;
+    top = blockBegin();
+    end = top + size;
+}
+
+/// \Returns \p p rounded up to a multiple of \p alignment
+static std::byte* alignUp(std::byte* p, size_t alignment) {
+    auto address = reinterpret_cast<uintptr_t>(p);
+    auto aligned = (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    return p + (aligned - address);
+}
+
+void* FrameArena::do_allocate(size_t size, size_t alignment) {
+    if (top) {
+        std::byte* result = alignUp(top, alignment);
+        if (result <= end && size <= (size_t)(end - result)) {
+            top = result + size;
+            return result;
+        }
+    }
+    addBlock(size + alignment);
+    std::byte* result = alignUp(top, alignment);
+    top = result + size;
+    return result;
+}
+
+void FrameArena::do_deallocate(void* p, size_t size, size_t) {
+    // Pointers of other blocks may compare equal to `top` by accident, so we
+    // only roll back allocations of the current block
+    auto* bytes = static_cast<std::byte*>(p);
+    if (std::less_equal<>{}(blockBegin(), bytes) &&
+        std::less<>{}(bytes, end) && bytes + size == top)
+    {
+        top = bytes;
+    }
+}
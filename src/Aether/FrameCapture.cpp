@@ -0,0 +1,347 @@
+#include "Aether/FrameCapture.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+#include <csp.hpp>
+
+using namespace xui;
+
+static constexpr std::array<char, 4> Magic = { 'X', 'U', 'I', 'C' };
+
+static_assert(sizeof(vml::float2) == 2 * sizeof(float),
+              "Vertices are stored as raw arrays of float pairs");
+
+/// Tag of the alternatives of `FillMode`
+enum class PaintType : uint8_t { Flat, Gradient };
+
+namespace {
+
+/// Binary serialization of the values of a capture
+struct Writer {
+    std::ostream& stream;
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void value(T const& value) {
+        stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void array(std::span<T const> values) {
+        stream.write(reinterpret_cast<char const*>(values.data()),
+                     (std::streamsize)values.size_bytes());
+    }
+
+    void point(vml::float2 v) {
+        value(v.x);
+        value(v.y);
+    }
+
+    void color(Color const& color) {
+        for (size_t i = 0; i < 4; ++i) {
+            value(color[i]);
+        }
+    }
+
+    void range(DirtyRange range) {
+        value<uint64_t>(range.begin);
+        value<uint64_t>(range.end);
+    }
+
+    void paint(FillMode const& fill) {
+        // clang-format off
+        std::visit(csp::overload{
+            [&](FlatColor const& c) {
+                value(PaintType::Flat);
+                color(c.color);
+            },
+            [&](Gradient const& g) {
+                value(PaintType::Gradient);
+                point(g.begin.coord);
+                color(g.begin.color);
+                point(g.end.coord);
+                color(g.end.color);
+            },
+        }, fill); // clang-format on
+    }
+
+    void drawCall(DrawCall const& dc) {
+        value<uint64_t>(dc.beginVertex);
+        value<uint64_t>(dc.endVertex);
+        value<uint64_t>(dc.beginIndex);
+        value<uint64_t>(dc.endIndex);
+        paint(dc.options.fill);
+        value<uint8_t>(dc.options.wireframe);
+        value(dc.options.fringeWidth);
+        value<uint8_t>(dc.options.weldVertices);
+        value<uint8_t>(dc.indexType == IndexType::UInt16);
+        point(dc.transform.column0);
+        point(dc.transform.column1);
+        point(dc.transform.translation);
+        point(dc.clipRect.min);
+        point(dc.clipRect.max);
+        value<uint64_t>(dc.beginInstance);
+        value<uint64_t>(dc.endInstance);
+    }
+
+    void instance(Instance const& inst) {
+        point(inst.offset);
+        point(inst.scale);
+        for (size_t i = 0; i < 4; ++i) {
+            value(inst.color[i]);
+        }
+    }
+};
+
+/// Binary deserialization of the values of a capture. Reads fail instead of
+/// allocating more memory than the rest of the file could fill
+struct Reader {
+    std::istream& stream;
+    uint64_t remaining;
+    bool ok = true;
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    T value() {
+        T result{};
+        if (ok && remaining >= sizeof(T)) {
+            stream.read(reinterpret_cast<char*>(&result), sizeof(T));
+            remaining -= sizeof(T);
+            ok = stream.good();
+        }
+        else {
+            ok = false;
+        }
+        return result;
+    }
+
+    /// Reads \p count elements into \p values
+    template <typename T>
+    void array(std::vector<T>& values, uint64_t count) {
+        if (!ok || count > remaining / sizeof(T)) {
+            ok = false;
+            return;
+        }
+        values.resize(count);
+        stream.read(reinterpret_cast<char*>(values.data()),
+                    (std::streamsize)(count * sizeof(T)));
+        remaining -= count * sizeof(T);
+        ok = stream.good();
+    }
+
+    /// Reads an element count and reserves space for that many elements of
+    /// at least \p minSize bytes each
+    template <typename T>
+    uint64_t count(std::vector<T>& values, size_t minSize) {
+        auto n = value<uint64_t>();
+        if (!ok || n > remaining / minSize) {
+            ok = false;
+            return 0;
+        }
+        values.clear();
+        values.reserve(n);
+        return n;
+    }
+
+    vml::float2 point() {
+        float x = value<float>();
+        float y = value<float>();
+        return { x, y };
+    }
+
+    Color color() {
+        Color result;
+        for (size_t i = 0; i < 4; ++i) {
+            result[i] = value<double>();
+        }
+        return result;
+    }
+
+    DirtyRange range() {
+        DirtyRange result;
+        result.begin = value<uint64_t>();
+        result.end = value<uint64_t>();
+        return result;
+    }
+
+    FillMode paint() {
+        switch (value<PaintType>()) {
+        case PaintType::Flat:
+            return FlatColor(color());
+        case PaintType::Gradient: {
+            Gradient g;
+            g.begin.coord = point();
+            g.begin.color = color();
+            g.end.coord = point();
+            g.end.color = color();
+            return g;
+        }
+        default:
+            ok = false;
+            return {};
+        }
+    }
+
+    DrawCall drawCall() {
+        DrawCall dc{};
+        dc.beginVertex = value<uint64_t>();
+        dc.endVertex = value<uint64_t>();
+        dc.beginIndex = value<uint64_t>();
+        dc.endIndex = value<uint64_t>();
+        dc.options.fill = paint();
+        dc.options.wireframe = value<uint8_t>() != 0;
+        dc.options.fringeWidth = value<float>();
+        dc.options.weldVertices = value<uint8_t>() != 0;
+        dc.indexType =
+            value<uint8_t>() != 0 ? IndexType::UInt16 : IndexType::UInt32;
+        dc.transform.column0 = point();
+        dc.transform.column1 = point();
+        dc.transform.translation = point();
+        dc.clipRect.min = point();
+        dc.clipRect.max = point();
+        dc.beginInstance = value<uint64_t>();
+        dc.endInstance = value<uint64_t>();
+        return dc;
+    }
+
+    Instance instance() {
+        Instance inst;
+        inst.offset = point();
+        inst.scale = point();
+        for (size_t i = 0; i < 4; ++i) {
+            inst.color[i] = value<float>();
+        }
+        return inst;
+    }
+};
+
+} // namespace
+
+FrameCaptureWriter::FrameCaptureWriter(std::filesystem::path const& path):
+    file(path, std::ios::binary | std::ios::trunc) {
+    Writer out{ file };
+    out.array(std::span<char const>(Magic));
+    out.value(FrameCaptureVersion);
+}
+
+void FrameCaptureWriter::write(DrawData const& data) {
+    Writer out{ file };
+    out.value<uint64_t>(data.vertices.size());
+    out.value<uint64_t>(data.indices.size());
+    out.value<uint64_t>(data.shortIndices.size());
+    out.range(data.dirtyVertices);
+    out.range(data.dirtyIndices);
+    out.range(data.dirtyShortIndices);
+    out.array(data.vertices);
+    out.array(data.coverage);
+    out.array(data.paintIndices);
+    out.array(data.indices);
+    out.array(data.shortIndices);
+    out.value<uint64_t>(data.paints.size());
+    for (auto& paint: data.paints) {
+        out.paint(paint);
+    }
+    out.value<uint64_t>(data.drawCalls.size());
+    for (auto& dc: data.drawCalls) {
+        out.drawCall(dc);
+    }
+    out.value<uint64_t>(data.instances.size());
+    for (auto& inst: data.instances) {
+        out.instance(inst);
+    }
+    file.flush();
+    ++_numFrames;
+}
+
+DrawData CapturedFrame::drawData() const {
+    return { .vertices = vertices,
+             .coverage = coverage,
+             .paintIndices = paintIndices,
+             .paints = paints,
+             .indices = indices,
+             .shortIndices = shortIndices,
+             .drawCalls = drawCalls,
+             .instances = instances,
+             .dirtyVertices = dirtyVertices,
+             .dirtyIndices = dirtyIndices,
+             .dirtyShortIndices = dirtyShortIndices };
+}
+
+FrameCaptureReader::FrameCaptureReader(std::filesystem::path const& path):
+    file(path, std::ios::binary) {
+    std::array<char, 4> magic{};
+    uint32_t version = 0;
+    file.read(magic.data(), magic.size());
+    file.read(reinterpret_cast<char*>(&version), sizeof version);
+    valid = file.good() && magic == Magic && version == FrameCaptureVersion;
+}
+
+/// \Returns true if the ranges of \p dc lie within the buffers of \p frame
+/// and its indices address vertices of its own vertex range
+static bool validate(CapturedFrame const& frame, DrawCall const& dc) {
+    if (dc.beginVertex > dc.endVertex || dc.endVertex > frame.vertices.size() ||
+        dc.beginIndex > dc.endIndex || dc.beginInstance > dc.endInstance ||
+        dc.endInstance > frame.instances.size())
+    {
+        return false;
+    }
+    size_t numVertices = dc.endVertex - dc.beginVertex;
+    auto check = [&](auto const& indices) {
+        if (dc.endIndex > indices.size()) {
+            return false;
+        }
+        return std::all_of(indices.begin() + (ptrdiff_t)dc.beginIndex,
+                           indices.begin() + (ptrdiff_t)dc.endIndex,
+                           [&](size_t i) { return i < numVertices; });
+    };
+    return dc.indexType == IndexType::UInt16 ? check(frame.shortIndices) :
+                                               check(frame.indices);
+}
+
+bool FrameCaptureReader::read(CapturedFrame& frame) {
+    if (!valid || file.peek() == std::char_traits<char>::eof()) {
+        return false;
+    }
+    auto position = file.tellg();
+    file.seekg(0, std::ios::end);
+    uint64_t remaining = (uint64_t)(file.tellg() - position);
+    file.seekg(position);
+    Reader in{ file, remaining };
+    auto numVertices = in.value<uint64_t>();
+    auto numIndices = in.value<uint64_t>();
+    auto numShortIndices = in.value<uint64_t>();
+    frame.dirtyVertices = in.range();
+    frame.dirtyIndices = in.range();
+    frame.dirtyShortIndices = in.range();
+    in.array(frame.vertices, numVertices);
+    in.array(frame.coverage, numVertices);
+    in.array(frame.paintIndices, numVertices);
+    in.array(frame.indices, numIndices);
+    in.array(frame.shortIndices, numShortIndices);
+    // Each paint, draw call and instance takes at least this many bytes
+    for (auto n = in.count(frame.paints, 1); in.ok && n > 0; --n) {
+        frame.paints.push_back(in.paint());
+    }
+    for (auto n = in.count(frame.drawCalls, 32); in.ok && n > 0; --n) {
+        frame.drawCalls.push_back(in.drawCall());
+    }
+    for (auto n = in.count(frame.instances, 32); in.ok && n > 0; --n) {
+        frame.instances.push_back(in.instance());
+    }
+    if (!in.ok) {
+        valid = false;
+        return false;
+    }
+    bool paintsValid =
+        std::ranges::all_of(frame.paintIndices, [&](uint32_t i) {
+        return i < frame.paints.size();
+    });
+    valid = paintsValid &&
+            std::ranges::all_of(frame.drawCalls, [&](DrawCall const& dc) {
+        return validate(frame, dc);
+    });
+    return valid;
+}
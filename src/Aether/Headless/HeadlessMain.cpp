@@ -0,0 +1,8 @@
+#include "Aether/Application.h"
+
+/// There is no event loop to run, so the application is created, which builds
+/// and lays out its windows, and destroyed again
+__attribute__((weak)) int main(int, char const**) {
+    auto app = xui::createApplication();
+    return 0;
+}
@@ -0,0 +1,14 @@
+#include "Aether/SoftwareRenderer.h"
+
+using namespace xui;
+
+std::unique_ptr<Renderer> xui::createRenderer(View* view,
+                                              RendererOptions const& options) {
+    return std::make_unique<SoftwareRenderer>(view, options);
+}
+
+void View::setShadow(ShadowConfig) {
+    // Shadows are not rendered, but like on other platforms the view must be
+    // drawable
+    (void)getDrawingContext();
+}
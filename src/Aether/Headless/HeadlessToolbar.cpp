@@ -0,0 +1,10 @@
+#include "Aether/Toolbar.h"
+
+#include "Aether/View.h"
+
+using namespace xui;
+
+ToolbarView::ToolbarView(std::vector<std::unique_ptr<View>> views):
+    _native(nullptr), _views(std::move(views)) {}
+
+void ToolbarView::layout(Rect frame) { _views[0]->layout(frame); }
@@ -0,0 +1,389 @@
+#include "Aether/View.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "Aether/ViewUtil.h"
+
+using namespace xui;
+using detail::PrivateViewKey;
+
+// MARK: - Native view
+
+namespace {
+
+/// Takes the place of the platform view. Stores the state that the platform
+/// view would store so layout can run and be measured without a window system
+struct HeadlessView {
+    Rect frame{};
+    /// Only used by scroll views
+    Size documentSize{};
+    Point scrollOffset{};
+    /// Only used by text fields and labels
+    std::string text;
+};
+
+} // namespace
+
+static HeadlessView* getNative(View const& view) {
+    return static_cast<HeadlessView*>(view.nativeHandle());
+}
+
+static void* makeNative(ViewOptions const&) { return new HeadlessView(); }
+
+void* detail::defaultNativeConstructor(ViewOptions const& options) {
+    return makeNative(options);
+}
+
+// MARK: - View
+
+View::~View() { delete getNative(*this); }
+
+Point View::origin() const {
+    auto* native = getNative(*this);
+    return native ? native->frame.origin() : Point{};
+}
+
+Size View::size() const {
+    auto* native = getNative(*this);
+    return native ? native->frame.size() : Size{};
+}
+
+void View::setNativeHandle(void* handle) {
+    assert(!_nativeHandle && "Handle is already set");
+    _nativeHandle = handle;
+}
+
+void View::setSubviews(std::vector<std::unique_ptr<View>> views) {
+    removeAllSubviews();
+    setSubviewsWeak(PrivateViewKey, std::move(views));
+}
+
+void View::removeAllSubviews() {
+    _subviews.clear();
+    setNeedsLayout();
+}
+
+void View::orderFront() {
+    if (!_parent) {
+        return;
+    }
+    auto& siblings = _parent->_subviews;
+    auto itr = std::find_if(siblings.begin(), siblings.end(),
+                            [&](auto& view) { return view.get() == this; });
+    std::rotate(itr, itr + 1, siblings.end());
+}
+
+void View::trackMouseMovement(MouseTrackingKind, MouseTrackingActivity) {}
+
+bool View::setFrame(Rect frame) {
+    auto* native = getNative(*this);
+    if (!native || native->frame == frame) {
+        return false;
+    }
+    native->frame = frame;
+    return true;
+}
+
+View* View::addSubview(std::unique_ptr<View> view) {
+    view->_parent = this;
+    _subviews.push_back(std::move(view));
+    setNeedsLayout();
+    return _subviews.back().get();
+}
+
+// MARK: - StackView
+
+StackView::StackView(Axis axis, std::vector<std::unique_ptr<View>> children):
+    View({ .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Flex,
+           .nativeConstructor = nativeConstructor }),
+    axis(axis) {
+    setSubviews(std::move(children));
+}
+
+void* StackView::nativeConstructor(ViewOptions const& options) {
+    return makeNative(options);
+}
+
+// MARK: - ScrollView
+
+ScrollView::ScrollView(Axis axis, std::vector<std::unique_ptr<View>> children):
+    View({ .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Flex,
+           .nativeConstructor = std::bind_front(nativeConstructor, axis) }),
+    axis(axis) {
+    setSubviewsWeak(PrivateViewKey, std::move(children));
+}
+
+void* ScrollView::nativeConstructor(Axis, ViewOptions const& options) {
+    return makeNative(options);
+}
+
+/// \Returns \p offset clamped such that the visible rect of \p native stays
+/// within its document
+static Point clampScrollOffset(HeadlessView const& native, Point offset) {
+    Size maxOffset =
+        max(Size(native.documentSize - native.frame.size()), Size{});
+    return clamp(offset, Point{}, Point(maxOffset));
+}
+
+void ScrollView::setDocumentSize(Size size) {
+    auto* native = getNative(*this);
+    native->documentSize = size;
+    native->scrollOffset = clampScrollOffset(*native, native->scrollOffset);
+}
+
+Rect ScrollView::visibleRect() const {
+    auto* native = getNative(*this);
+    return { native->scrollOffset, native->frame.size() };
+}
+
+void ScrollView::scrollTo(Point offset) {
+    auto* native = getNative(*this);
+    offset = clampScrollOffset(*native, offset);
+    if (offset == native->scrollOffset) {
+        return;
+    }
+    native->scrollOffset = offset;
+    didScroll();
+}
+
+View* ScrollView::addDocumentSubview(std::unique_ptr<View> view) {
+    return addSubviewWeak(PrivateViewKey, std::move(view));
+}
+
+std::unique_ptr<View> ScrollView::removeDocumentSubview(View* view) {
+    return removeSubviewWeak(PrivateViewKey, view);
+}
+
+void xui::applyModifier(NoBackgroundT, ScrollView&) {}
+
+// MARK: - SplitView
+
+SplitView::SplitView(Axis axis, std::vector<std::unique_ptr<View>> children):
+    View({ .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Flex,
+           .nativeConstructor =
+               std::bind_front(nativeConstructor, this, axis) }),
+    axis(axis) {
+    setSubviews(std::move(children));
+    setSplitterStyle(_splitterStyle);
+}
+
+void* SplitView::nativeConstructor(SplitView*, Axis,
+                                   ViewOptions const& options) {
+    return makeNative(options);
+}
+
+void SplitView::setSplitterStyle(SplitterStyle style) {
+    _splitterStyle = style;
+    setNeedsLayout();
+}
+
+void SplitView::setSplitterColor(std::optional<Color> color) {
+    _splitterColor = color;
+}
+
+void SplitView::setSplitterThickness(std::optional<double> thickness) {
+    _splitterThickness = thickness;
+    setNeedsLayout();
+}
+
+/// Divider thicknesses of the AppKit splitter styles
+static double defaultThickness(SplitterStyle style) {
+    using enum SplitterStyle;
+    switch (style) {
+    case Thin:
+        return 1;
+    case Thick:
+        return 9;
+    case Pane:
+        return 9;
+    }
+    assert(false);
+    return 1;
+}
+
+double SplitView::dividerThickness() const {
+    return splitterThickness().value_or(defaultThickness(splitterStyle()));
+}
+
+double SplitView::sizeWithoutDividers() const {
+    return size()[axis] - dividerThickness() * (numSubviews() - 1);
+}
+
+bool SplitView::isChildCollapsed(size_t) const {
+    // Without user interaction nothing collapses
+    return false;
+}
+
+void SplitView::doLayout(Rect frame) {
+    setFrame(frame);
+    if (numSubviews() == 0) {
+        return;
+    }
+    double thickness = dividerThickness();
+    double totalSize = sizeWithoutDividers();
+    if (childFractions.empty()) {
+        double frac = 1.0 / numSubviews();
+        childFractions.resize(numSubviews(), frac);
+    }
+    double offset = 0;
+    for (size_t i = 0; i < numSubviews(); ++i) {
+        if (isChildCollapsed(i)) {
+            offset += thickness;
+            continue;
+        }
+        double childSize = totalSize * childFractions[i];
+        Rect childFrame = { Point(axis, offset), frame.size() };
+        childFrame.size()[axis] = childSize;
+        subviewAt(i)->layout(childFrame);
+        offset += childSize + thickness;
+    }
+}
+
+// MARK: - TabView
+
+TabView::TabView(std::vector<TabViewElement> elems):
+    View({ .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Flex,
+           .nativeConstructor = nativeConstructor }),
+    elements(std::move(elems)) {
+    for (auto& [title, child]: elements) {
+        child->_parent = this;
+    }
+}
+
+void* TabView::nativeConstructor(ViewOptions const& options) {
+    return makeNative(options);
+}
+
+void TabView::setTabPosition(TabPosition position) {
+    _tabPosition = position;
+    setNeedsLayout();
+}
+
+void TabView::setBorder(TabViewBorder border) {
+    _border = border;
+    setNeedsLayout();
+}
+
+void TabView::doLayout(Rect frame) {
+    setFrame(frame);
+    for (auto& [title, child]: elements) {
+        child->layout(bounds());
+    }
+}
+
+// MARK: - Button
+
+ButtonView::ButtonView(std::string label, std::function<void()> action,
+                       ButtonType type):
+    View({ .minSize = { 80, 34 }, .nativeConstructor = makeNative }),
+    _type(type),
+    _label(std::move(label)),
+    _action(std::move(action)) {}
+
+void ButtonView::setBezelStyle(BezelStyle style) { _bezelStyle = style; }
+
+void ButtonView::setLabel(std::string label) { _label = std::move(label); }
+
+// MARK: - Switch
+
+/// Intrinsic content size of `NSSwitch`
+static constexpr Size SwitchSize = { 38, 22 };
+
+SwitchView::SwitchView():
+    View({ .minSize = SwitchSize, .nativeConstructor = makeNative }) {}
+
+// MARK: - TextField
+
+TextFieldView::TextFieldView(std::string defaultText):
+    View({ .minSize = { 80, 32 },
+           .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Static,
+           .nativeConstructor = makeNative }) {
+    getNative(*this)->text = std::move(defaultText);
+    setAttribute<ViewAttributeKey::PaddingX>(6);
+    setAttribute<ViewAttributeKey::PaddingY>(6);
+}
+
+void TextFieldView::setText(std::string text) {
+    getNative(*this)->text = std::move(text);
+}
+
+std::string TextFieldView::getText() const { return getNative(*this)->text; }
+
+// MARK: - LabelView
+
+LabelView::LabelView(StringProxy text):
+    View({ .minSize = { 80, 22 },
+           .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Static,
+           .nativeConstructor = makeNative }),
+    _text(std::move(text)) {
+    getNative(*this)->text = _text.get();
+}
+
+void LabelView::setText(StringProxy text) {
+    getNative(*this)->text = text.get();
+    _text = std::move(text);
+}
+
+void LabelView::doLayout(Rect frame) {
+    setFrame(frame);
+    getNative(*this)->text = _text.get();
+}
+
+// MARK: - ProgressIndicatorView
+
+static Size progressMinSize(ProgressIndicatorView::Style style) {
+    using enum ProgressIndicatorView::Style;
+    switch (style) {
+    case Bar:
+        return { 0, 10 };
+    case Spinner:
+        return { 20, 20 };
+    }
+    assert(false);
+    return {};
+}
+
+ProgressIndicatorView::ProgressIndicatorView(Style style):
+    View({ .minSize = progressMinSize(style),
+           .layoutModeX = style == Bar ? LayoutMode::Flex : LayoutMode::Static,
+           .layoutModeY = LayoutMode::Static,
+           .nativeConstructor = makeNative }) {}
+
+// MARK: - ColorView
+
+ColorView::ColorView(Color const&):
+    View({ .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Flex,
+           .nativeConstructor = makeNative }) {}
+
+void ColorView::doLayout(Rect frame) { setFrame(frame); }
+
+// MARK: - VisualEffectView
+
+VisualEffectView::VisualEffectView(VisualEffectBlendMode blendMode,
+                                   std::unique_ptr<View> subview):
+    View({ .layoutModeX = LayoutMode::Flex,
+           .layoutModeY = LayoutMode::Flex,
+           .nativeConstructor =
+               std::bind_front(nativeConstructor, blendMode) }) {
+    addSubview(std::move(subview));
+}
+
+void* VisualEffectView::nativeConstructor(VisualEffectBlendMode,
+                                          ViewOptions const& options) {
+    return makeNative(options);
+}
+
+void VisualEffectView::doLayout(Rect frame) {
+    setFrame(frame);
+    for (auto* view: subviews()) {
+        view->layout(bounds());
+    }
+}
@@ -0,0 +1,59 @@
+#include "Aether/Window.h"
+
+#include "Aether/Toolbar.h"
+#include "Aether/View.h"
+
+using namespace xui;
+
+namespace {
+
+/// Takes the place of the platform window
+struct HeadlessWindow {
+    Rect frame;
+};
+
+} // namespace
+
+struct internal::WindowImpl {
+    static HeadlessWindow* getNative(Window const& window) {
+        return static_cast<HeadlessWindow*>(window._handle);
+    }
+
+    static void layoutContent(Window& window) {
+        if (!window._content) {
+            return;
+        }
+        auto size = getNative(window)->frame.size();
+        window._content->layout({ { 0, 0 }, size });
+    }
+};
+
+using Impl = internal::WindowImpl;
+
+Window::Window(std::string title, Rect frame, WindowProperties props,
+               std::unique_ptr<View> content):
+    _handle(new HeadlessWindow{ frame }),
+    _title(std::move(title)),
+    _props(props) {
+    setContentView(std::move(content));
+}
+
+Window::~Window() { delete Impl::getNative(*this); }
+
+void Window::setFrame(Rect frame, bool) {
+    Impl::getNative(*this)->frame = frame;
+    Impl::layoutContent(*this);
+}
+
+void Window::setTitle(std::string title) { _title = std::move(title); }
+
+void Window::setContentView(std::unique_ptr<View> view) {
+    _content = std::move(view);
+    Impl::layoutContent(*this);
+}
+
+void Window::setToolbar(std::unique_ptr<ToolbarView> toolbar) {
+    _toolbar = std::move(toolbar);
+}
+
+Rect Window::frame() const { return Impl::getNative(*this)->frame; }
@@ -1,6 +1,8 @@
 #include "Aether/DrawingContext.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <vector>
 
 #import <Cocoa/Cocoa.h>
@@ -14,7 +16,14 @@ using namespace xui;
 using namespace vml::short_types;
 
 static constexpr size_t VertexSize = sizeof(float2);
+static constexpr size_t CoverageSize = sizeof(float);
+static constexpr size_t PaintIndexSize = sizeof(uint32_t);
 static constexpr size_t IndexSize = sizeof(uint32_t);
+static constexpr size_t ShortIndexSize = sizeof(uint16_t);
+
+// The shader reads transforms as three packed `float2` columns
+static_assert(sizeof(Transform2D) == 6 * sizeof(float));
+static_assert(sizeof(Instance) == 8 * sizeof(float));
 
 static MTLPixelFormat toMTL(PixelFormat fmt) {
     using enum PixelFormat;
@@ -27,6 +36,15 @@ static MTLPixelFormat toMTL(PixelFormat fmt) {
 
 namespace {
 
+enum class FillModeType { FlatColor, Gradient };
+
+/// Per paint data of the fragment shader
+struct UniformData {
+    FillModeType fillMode;
+    vml::float4 color, alternateColor;
+    vml::float2 beginCoord, endCoord;
+};
+
 struct MacOSRenderer: xui::Renderer {
     id<MTLDevice> device;
     id<MTLCommandQueue> commandQueue;
@@ -37,21 +55,23 @@ struct MacOSRenderer: xui::Renderer {
     // Rendering objects
     id<MTLRenderPipelineState> pipeline;
     id<MTLBuffer> vertexBuffer;
+    id<MTLBuffer> coverageBuffer;
+    id<MTLBuffer> paintIndexBuffer;
     id<MTLBuffer> indexBuffer;
+    id<MTLBuffer> shortIndexBuffer;
+    id<MTLBuffer> instanceBuffer;
     id<MTLBuffer> transformMatrixBuffer;
-    std::vector<id<MTLBuffer>> uniformBuffers;
+    id<MTLBuffer> paintBuffer;
+    std::vector<UniformData> paintData;
+    std::vector<Instance> instanceData;
     RendererOptions options;
 
     MacOSRenderer(View* view, RendererOptions const& options);
     void createRenderingState();
-    id<MTLBuffer> __strong* getUniformBuffer(size_t index);
 
-    void render(std::span<float2 const> vertices,
-                std::span<uint32_t const> indices,
-                std::span<DrawCall const> drawCalls) final;
+    void render(DrawData const& data) final;
 
-    void uploadDrawData(std::span<float2 const> vertices,
-                        std::span<uint32_t const> indices);
+    void uploadDrawData(DrawData const& data);
 };
 
 } // namespace
@@ -71,18 +91,6 @@ MacOSRenderer::MacOSRenderer(View* view, RendererOptions const& options):
     createRenderingState();
 }
 
-namespace {
-
-enum class FillModeType { FlatColor, Gradient };
-
-struct UniformData {
-    FillModeType fillMode;
-    vml::float4 color, alternateColor;
-    vml::float2 beginCoord, endCoord;
-};
-
-} // namespace
-
 constexpr auto ShaderSource = R"(
 #include <metal_stdlib>
 
@@ -96,26 +104,61 @@ struct UniformData {
     float2 beginCoord, endCoord;
 };
 
-vertex float4 vertex_main(float2 device const* vertices [[buffer(0)]],
-                          float4x4 device const& transform [[buffer(1)]],
-                          UniformData device const& uniforms [[buffer(2)]],
-                          uint vertexID [[vertex_id]]) {
-    return transform * float4(vertices[vertexID], 0, 1);
+struct Transform2D {
+    float2 column0, column1, translation;
+};
+
+struct Instance {
+    float2 offset, scale;
+    float4 color;
+};
+
+struct VertexOut {
+    float4 position [[position]];
+    /// Untransformed position that gradients are evaluated at
+    float2 local;
+    float coverage;
+    uint paint [[flat]];
+    float4 tint [[flat]];
+};
+
+vertex VertexOut vertex_main(float2 device const* vertices [[buffer(0)]],
+                             float4x4 device const& transform [[buffer(1)]],
+                             float device const* coverage [[buffer(2)]],
+                             uint device const* paintIndices [[buffer(3)]],
+                             Transform2D constant& drawTransform [[buffer(4)]],
+                             Instance device const* instances [[buffer(5)]],
+                             uint vertexID [[vertex_id]],
+                             uint instanceID [[instance_id]]) {
+    float2 local = vertices[vertexID];
+    Instance instance = instances[instanceID];
+    float2 p = instance.offset + instance.scale * local;
+    float2 position = p.x * drawTransform.column0 +
+                      p.y * drawTransform.column1 +
+                      drawTransform.translation;
+    return { transform * float4(position, 0, 1), local, coverage[vertexID],
+             paintIndices[vertexID], instance.color };
 }
 
-fragment float4 fragment_main(float4 position [[position]], UniformData device const& uniforms [[buffer(0)]]) {
+float4 fillColor(float2 position, UniformData device const& uniforms) {
     switch (uniforms.fillMode) {
     case FlatColor:
         return uniforms.color;
     case Gradient: {
         float2 d = uniforms.endCoord - uniforms.beginCoord;
-        float2 p = position.xy - uniforms.beginCoord;
+        float2 p = position - uniforms.beginCoord;
         float t = dot(p, d) / dot(d, d);
         return mix(uniforms.color, uniforms.alternateColor, clamp(t, 0.0f, 1.0f));
     }
     }
     return {};
 }
+
+fragment float4 fragment_main(VertexOut in [[stage_in]], UniformData device const* paints [[buffer(0)]]) {
+    float4 color = fillColor(in.local, paints[in.paint]) * in.tint;
+    color.a *= in.coverage;
+    return color;
+}
 )";
 
 void MacOSRenderer::createRenderingState() {
@@ -139,6 +182,20 @@ void MacOSRenderer::createRenderingState() {
     pipelineDescriptor.fragmentFunction = fragmentFunction;
     pipelineDescriptor.colorAttachments[0].pixelFormat =
         toMTL(options.pixelFormat);
+    // Blending is required for anti-aliasing fringes. The layer expects
+    // premultiplied alpha, which this produces when blending onto the cleared
+    // transparent drawable
+    MTLRenderPipelineColorAttachmentDescriptor* colorAttachment =
+        pipelineDescriptor.colorAttachments[0];
+    colorAttachment.blendingEnabled = YES;
+    colorAttachment.rgbBlendOperation = MTLBlendOperationAdd;
+    colorAttachment.alphaBlendOperation = MTLBlendOperationAdd;
+    colorAttachment.sourceRGBBlendFactor = MTLBlendFactorSourceAlpha;
+    colorAttachment.sourceAlphaBlendFactor = MTLBlendFactorOne;
+    colorAttachment.destinationRGBBlendFactor =
+        MTLBlendFactorOneMinusSourceAlpha;
+    colorAttachment.destinationAlphaBlendFactor =
+        MTLBlendFactorOneMinusSourceAlpha;
     pipeline = [device newRenderPipelineStateWithDescriptor:pipelineDescriptor
                                                       error:&error];
     if (error) {
@@ -146,13 +203,6 @@ void MacOSRenderer::createRenderingState() {
     }
 }
 
-id<MTLBuffer> __strong* MacOSRenderer::getUniformBuffer(size_t index) {
-    if (index >= uniformBuffers.size()) {
-        uniformBuffers.resize(std::max(index + 1, uniformBuffers.size() * 2));
-    }
-    return &uniformBuffers[index];
-}
-
 static void uploadData(id<MTLDevice> device, id<MTLBuffer> __strong* buffer,
                        void const* data, size_t size) {
     if ((!*buffer && size > 0) || (*buffer).length < size) {
@@ -164,7 +214,24 @@ static void uploadData(id<MTLDevice> device, id<MTLBuffer> __strong* buffer,
     std::memcpy([*buffer contents], data, size);
 }
 
-static UniformData makeUniformData(DrawCallOptions const& opt) {
+/// Updates the elements in \p dirty of \p buffer with \p data. Uploads all of
+/// \p data if the buffer has to be reallocated
+template <typename T>
+static void uploadData(id<MTLDevice> device, id<MTLBuffer> __strong* buffer,
+                       std::span<T const> data, DirtyRange dirty) {
+    if ((!*buffer && !data.empty()) || (*buffer).length < data.size_bytes()) {
+        uploadData(device, buffer, data.data(), data.size_bytes());
+        return;
+    }
+    size_t begin = std::min(dirty.begin, data.size());
+    size_t end = std::min(dirty.end, data.size());
+    if (begin < end) {
+        std::memcpy(static_cast<T*>([*buffer contents]) + begin,
+                    data.data() + begin, (end - begin) * sizeof(T));
+    }
+}
+
+static UniformData makeUniformData(FillMode const& paint) {
     // clang-format off
     return std::visit(csp::overload{
         [](FlatColor const& c) -> UniformData {
@@ -182,13 +249,29 @@ static UniformData makeUniformData(DrawCallOptions const& opt) {
                 .endCoord = g.end.coord
             };
         },
-    }, opt.fill); // clang-format on
+    }, paint); // clang-format on
 }
 
-void MacOSRenderer::render(std::span<float2 const> vertices,
-                           std::span<uint32_t const> indices,
-                           std::span<DrawCall const> drawCalls) {
+/// \Returns the pixels whose centers lie in \p clip, clamped to \p size
+static MTLScissorRect toScissorRect(ClipRect const& clip, double scale,
+                                    CGSize size) {
+    auto bound = [&](float value, double limit) {
+        return (NSUInteger)std::clamp(std::ceil(value * scale - 0.5), 0.0,
+                                      limit);
+    };
+    NSUInteger minX = bound(clip.min.x, size.width);
+    NSUInteger minY = bound(clip.min.y, size.height);
+    NSUInteger maxX = bound(clip.max.x, size.width);
+    NSUInteger maxY = bound(clip.max.y, size.height);
+    return { minX, minY, maxX > minX ? maxX - minX : 0,
+             maxY > minY ? maxY - minY : 0 };
+}
+
+void MacOSRenderer::render(DrawData const& data) {
     if (!pipeline) return;
+    // Data is uploaded even if no drawable is available because the dirty
+    // ranges of the next frame are relative to this frame
+    uploadDrawData(data);
     CGSize newSize = nativeView.bounds.size;
     newSize.width *= metalLayer.contentsScale;
     newSize.height *= metalLayer.contentsScale;
@@ -197,7 +280,6 @@ void MacOSRenderer::render(std::span<float2 const> vertices,
     }
     id<CAMetalDrawable> drawable = [metalLayer nextDrawable];
     if (!drawable) return;
-    uploadDrawData(vertices, indices);
     MTLRenderPassDescriptor* passDescriptor =
         [MTLRenderPassDescriptor renderPassDescriptor];
     id<MTLTexture> tex = drawable.texture;
@@ -213,34 +295,72 @@ void MacOSRenderer::render(std::span<float2 const> vertices,
     [encoder setCullMode:MTLCullModeNone];
     [encoder setVertexBuffer:vertexBuffer offset:0 atIndex:0];
     [encoder setVertexBuffer:transformMatrixBuffer offset:0 atIndex:1];
-    for (size_t DCIndex = 0; auto& drawCall: drawCalls) {
-        auto* uniformBuffer = getUniformBuffer(DCIndex);
-        UniformData uniformData = makeUniformData(drawCall.options);
-        uploadData(device, uniformBuffer, &uniformData, sizeof uniformData);
-        [encoder setFragmentBuffer:*uniformBuffer offset:0 atIndex:0];
+    [encoder setVertexBuffer:coverageBuffer offset:0 atIndex:2];
+    [encoder setVertexBuffer:paintIndexBuffer offset:0 atIndex:3];
+    [encoder setVertexBuffer:instanceBuffer offset:0 atIndex:5];
+    [encoder setFragmentBuffer:paintBuffer offset:0 atIndex:0];
+    for (auto& drawCall: data.drawCalls) {
+        auto scissorRect = toScissorRect(drawCall.clipRect,
+                                         metalLayer.contentsScale, newSize);
+        if (scissorRect.width == 0 || scissorRect.height == 0) {
+            continue;
+        }
+        [encoder setScissorRect:scissorRect];
+        [encoder setVertexBytes:&drawCall.transform
+                         length:sizeof(Transform2D)
+                        atIndex:4];
+        // Draw calls without instances are drawn as the default instance at
+        // the beginning of the instance buffer
+        size_t beginInstance = 0, numInstances = 1;
+        if (drawCall.instanced()) {
+            beginInstance = drawCall.beginInstance + 1;
+            numInstances = drawCall.endInstance - drawCall.beginInstance;
+        }
+        [encoder setVertexBufferOffset:beginInstance * sizeof(Instance)
+                               atIndex:5];
         [encoder setTriangleFillMode:drawCall.options.wireframe ?
                                          MTLTriangleFillModeLines :
                                          MTLTriangleFillModeFill];
         [encoder setVertexBufferOffset:drawCall.beginVertex * VertexSize
                                atIndex:0];
+        [encoder setVertexBufferOffset:drawCall.beginVertex * CoverageSize
+                               atIndex:2];
+        [encoder setVertexBufferOffset:drawCall.beginVertex * PaintIndexSize
+                               atIndex:3];
+        bool isShort = drawCall.indexType == IndexType::UInt16;
         [encoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
                             indexCount:drawCall.endIndex - drawCall.beginIndex
-                             indexType:MTLIndexTypeUInt32
-                           indexBuffer:indexBuffer
-                     indexBufferOffset:drawCall.beginIndex * IndexSize];
-        ++DCIndex;
+                             indexType:isShort ? MTLIndexTypeUInt16 :
+                                                 MTLIndexTypeUInt32
+                           indexBuffer:isShort ? shortIndexBuffer : indexBuffer
+                     indexBufferOffset:drawCall.beginIndex *
+                                       (isShort ? ShortIndexSize : IndexSize)
+                         instanceCount:numInstances];
     }
     [encoder endEncoding];
     [commandBuffer presentDrawable:drawable];
     [commandBuffer commit];
 }
 
-void MacOSRenderer::uploadDrawData(std::span<float2 const> vertices,
-                                   std::span<uint32_t const> indices) {
-    uploadData(device, &vertexBuffer, vertices.data(),
-               vertices.size() * VertexSize);
-    uploadData(device, &indexBuffer, indices.data(),
-               indices.size() * IndexSize);
+void MacOSRenderer::uploadDrawData(DrawData const& data) {
+    uploadData(device, &vertexBuffer, data.vertices, data.dirtyVertices);
+    uploadData(device, &coverageBuffer, data.coverage, data.dirtyVertices);
+    uploadData(device, &paintIndexBuffer, data.paintIndices,
+               data.dirtyVertices);
+    uploadData(device, &indexBuffer, data.indices, data.dirtyIndices);
+    uploadData(device, &shortIndexBuffer, data.shortIndices,
+               data.dirtyShortIndices);
+    instanceData.assign(1, Instance{});
+    instanceData.insert(instanceData.end(), data.instances.begin(),
+                        data.instances.end());
+    uploadData(device, &instanceBuffer, instanceData.data(),
+               instanceData.size() * sizeof(Instance));
+    paintData.clear();
+    for (auto& paint: data.paints) {
+        paintData.push_back(makeUniformData(paint));
+    }
+    uploadData(device, &paintBuffer, paintData.data(),
+               paintData.size() * sizeof(UniformData));
     float l = 0;
     float r = view->size().width();
     float t = 0;
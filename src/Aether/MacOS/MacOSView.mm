@@ -118,13 +118,22 @@ struct EventTranslator {
 
 struct View::EventImpl {
     static auto* getHandler(View& view, EventType type) {
-        auto itr = view._eventHandlers.find(type);
-        return itr != view._eventHandlers.end() ? &itr->second : nullptr;
+        return view._handledEvents & eventTypeBit(type) ?
+                   &(*view._eventHandlers)[(size_t)type] :
+                   nullptr;
     }
     static bool handleEvent(EventType type, View& view,
                             NSEvent __weak* nativeEvent) {
+        // Most views on the responder chain do not listen to high rate events
+        // like mouse moves and scrolls, so we pass them on without translating
+        // the event
+        if (!view.listensTo(type)) {
+            return false;
+        }
         auto event = EventTranslator{ view, nativeEvent }.to(type);
-        if (event.visit([&](auto& event) { return view.onEvent(event); })) {
+        if (!(view._declinedEvents & eventTypeBit(type)) &&
+            event.visit([&](auto& event) { return view.onEvent(event); }))
+        {
             return true;
         }
         auto* handler = getHandler(view, type);
@@ -328,6 +337,7 @@ void View::removeAllSubviews() {
         [subview removeFromSuperview];
     }
     _subviews.clear();
+    setNeedsLayout();
 }
 
 void View::orderFront() {
@@ -349,43 +359,6 @@ void View::orderFront() {
                           context:nativeHandle()];
 }
 
-template <EventType ID, size_t Index = 0, auto... DerivedIDs>
-struct DerivedEventTypeListImpl:
-    std::conditional_t<csp::impl::IDIsConcrete<(EventType)Index> &&
-                           csp::impl::ctIsaImpl(ID, (EventType)Index),
-                       DerivedEventTypeListImpl<ID, Index + 1, DerivedIDs...,
-                                                (EventType)Index>,
-                       DerivedEventTypeListImpl<ID, Index + 1, DerivedIDs...>> {
-};
-
-template <EventType ID, auto... DerivedIDs>
-struct DerivedEventTypeListImpl<ID, csp::impl::IDTraits<EventType>::count,
-                                DerivedIDs...> {
-    static constexpr size_t Count = sizeof...(DerivedIDs);
-    static constexpr std::array<EventType, Count> value = { DerivedIDs... };
-};
-
-template <EventType ID>
-static constexpr auto DerivedEventTypeList =
-    DerivedEventTypeListImpl<ID>::value;
-
-void View::installEventHandler(EventType type,
-                               std::function<bool(EventUnion const&)> handler) {
-    [&]<size_t... I>(std::index_sequence<I...>) {
-        auto makeImpl = []<size_t J>() {
-            return [](View& view,
-                      std::function<bool(EventUnion const&)> const& handler) {
-                auto list = DerivedEventTypeList<(EventType)J>;
-                for (EventType ID: list) {
-                    view._eventHandlers.insert_or_assign(ID, handler);
-                }
-            };
-        };
-        return std::array { +makeImpl.template operator()<I>()... };
-    }(std::make_index_sequence<csp::impl::IDTraits<EventType>::count>{})[(
-        size_t)type](*this, handler);
-}
-
 static SEL const UpdateTrackingAreaSelector =
     NSSelectorFromString(@"updateTrackingArea:activity:");
 
@@ -424,6 +397,7 @@ View* View::addSubview(std::unique_ptr<View> view) {
     }
     view->_parent = this;
     _subviews.push_back(std::move(view));
+    setNeedsLayout();
     return _subviews.back().get();
 }
 
@@ -446,6 +420,22 @@ void* StackView::nativeConstructor(ViewOptions const&) {
 
 EVENT_VIEW_SUBCLASS(EventScrollView, NSScrollView)
 
+struct ScrollView::Impl {
+    static void didScroll(ScrollView& view) { view.didScroll(); }
+};
+
+/// Clip view that notifies the scroll view when the visible rect changes
+@interface AetherClipView: NSClipView
+@end
+@implementation AetherClipView
+- (void)setBoundsOrigin:(NSPoint)newOrigin {
+    [super setBoundsOrigin:newOrigin];
+    if (auto* view = getView<ScrollView>(self.superview)) {
+        ScrollView::Impl::didScroll(*view);
+    }
+}
+@end
+
 ScrollView::ScrollView(Axis axis, std::vector<std::unique_ptr<View>> children):
     View({ .layoutModeX = LayoutMode::Flex,
            .layoutModeY = LayoutMode::Flex,
@@ -461,15 +451,62 @@ ScrollView::ScrollView(Axis axis, std::vector<std::unique_ptr<View>> children):
 void* ScrollView::nativeConstructor(Axis axis, ViewOptions const&) {
     NSView* content = [[NSView alloc] init];
     NSScrollView* scrollView = [[EventScrollView alloc] init];
+    scrollView.contentView = [[AetherClipView alloc] init];
     [scrollView setDocumentView:content];
     scrollView.hasHorizontalScroller = axis == Axis::X;
     scrollView.hasVerticalScroller = axis == Axis::Y;
     return retain(scrollView);
 }
 
-void ScrollView::setDocumentSize(Size size) {
+void ScrollView::setDocumentSize(xui::Size size) {
     NSScrollView* view = transfer(nativeHandle());
-    view.documentView.frame = { {}, toNSSize(size) };
+    NSView* document = view.documentView;
+    NSClipView* clipView = view.contentView;
+    double delta = size.height() - document.frame.size.height;
+    NSPoint scrollPosition = clipView.bounds.origin;
+    document.frame = { {}, toNSSize(size) };
+    if (delta == 0) {
+        return;
+    }
+    // AppKit coordinates grow upwards, so we move the subviews and the scroll
+    // position such that their distance to the top of the document stays the
+    // same
+    for (NSView* subview in document.subviews) {
+        NSPoint origin = subview.frame.origin;
+        [subview setFrameOrigin:NSMakePoint(origin.x, origin.y + delta)];
+    }
+    scrollPosition.y += delta;
+    NSRect visible = { scrollPosition, clipView.bounds.size };
+    [clipView scrollToPoint:[clipView constrainBoundsRect:visible].origin];
+    [view reflectScrolledClipView:clipView];
+}
+
+xui::Rect ScrollView::visibleRect() const {
+    NSScrollView* view = transfer(nativeHandle());
+    return fromAppkitCoords(view.documentVisibleRect,
+                            view.documentView.frame.size.height);
+}
+
+void ScrollView::scrollTo(xui::Point offset) {
+    NSScrollView* view = transfer(nativeHandle());
+    NSClipView* clipView = view.contentView;
+    xui::Rect target = { offset, fromNSSize(clipView.bounds.size) };
+    NSRect visible =
+        toAppkitCoords(target, view.documentView.frame.size.height);
+    [clipView scrollToPoint:[clipView constrainBoundsRect:visible].origin];
+    [view reflectScrolledClipView:clipView];
+}
+
+View* ScrollView::addDocumentSubview(std::unique_ptr<View> view) {
+    NSScrollView* native = transfer(nativeHandle());
+    [native.documentView addSubview:transfer(view->nativeHandle())];
+    return addSubviewWeak(PrivateViewKey, std::move(view));
+}
+
+std::unique_ptr<View> ScrollView::removeDocumentSubview(View* view) {
+    NSView* nativeChild = transfer(view->nativeHandle());
+    [nativeChild removeFromSuperview];
+    return removeSubviewWeak(PrivateViewKey, view);
 }
 
 void xui::applyModifier(NoBackgroundT, ScrollView& view) {
@@ -574,6 +611,7 @@ void SplitView::setSplitterStyle(SplitterStyle style) {
     _splitterStyle = style;
     NSSplitView* view = transfer(nativeHandle());
     view.dividerStyle = toNS(style);
+    setNeedsLayout();
 }
 
 void SplitView::setSplitterColor(std::optional<Color> color) {
@@ -586,12 +624,16 @@ void SplitView::setSplitterThickness(std::optional<double> thickness) {
     _splitterThickness = thickness;
     AetherSplitView* view = transfer(nativeHandle());
     view.divThickness = thickness;
+    setNeedsLayout();
 }
 
-double SplitView::sizeWithoutDividers() const {
+double SplitView::dividerThickness() const {
     NSSplitView* view = transfer(nativeHandle());
-    double totalSize = fromNSSize(view.frame.size)[axis];
-    return totalSize - view.dividerThickness * (numSubviews() - 1);
+    return view.dividerThickness;
+}
+
+double SplitView::sizeWithoutDividers() const {
+    return size()[axis] - dividerThickness() * (numSubviews() - 1);
 }
 
 bool SplitView::isChildCollapsed(size_t childIndex) const {
@@ -645,6 +687,8 @@ void SplitView::didResizeSubviews() {
     if (fracSum != 1.0) {
         handleSplitViewResize(resizeStrategy(), fracSum, childFractions);
     }
+    // The frame is unchanged but the fractions are not
+    setNeedsLayout();
     layout(frame);
 }
 
@@ -658,26 +702,28 @@ double SplitView::constrainSplitPosition(double proposedPosition,
     leftPosition.y += left->size().height();
     leftPosition.y = size().height() - leftPosition.y;
     double currentPosition = leftPosition[axis] + left->size()[axis];
-    if (left->size()[axis] <= left->minSize()[axis] &&
-        right->size()[axis] <= right->minSize()[axis])
-    {
+    // Measured minimums include the content of nested stacks
+    xui::Size squeezed = size();
+    squeezed[axis] = 0;
+    double leftMin = left->measure(squeezed)[axis];
+    double rightMin = right->measure(squeezed)[axis];
+    if (left->size()[axis] <= leftMin && right->size()[axis] <= rightMin) {
         return currentPosition;
     }
     double offset = proposedPosition - currentPosition;
     double leftNewSize = left->size()[axis] + offset;
-    if (left->minSize()[axis] > leftNewSize) {
-        return leftPosition[axis] + left->minSize()[axis];
+    if (leftMin > leftNewSize) {
+        return leftPosition[axis] + leftMin;
     }
     double rightNewSize = right->size()[axis] - offset;
-    if (right->minSize()[axis] > rightNewSize) {
-        return currentPosition + right->size()[axis] - right->minSize()[axis];
+    if (rightMin > rightNewSize) {
+        return currentPosition + right->size()[axis] - rightMin;
     }
     return proposedPosition;
 }
 
 void SplitView::doLayout(Rect frame) {
-    NSSplitView* view = transfer(nativeHandle());
-    double dividerThickness = view.dividerThickness;
+    double dividerThickness = this->dividerThickness();
     if (setFrame(frame) && !childFractions.empty()) {
         return;
     }
@@ -0,0 +1,76 @@
+#include "Aether/MeshCache.h"
+
+#include <algorithm>
+#include <bit>
+
+using namespace xui;
+
+/// FNV-1a step over a 32 bit word
+static void hashWord(size_t& hash, uint32_t word) {
+    hash ^= word;
+    hash *= 0x100000001b3;
+}
+
+MeshKey::MeshKey(std::span<std::span<vml::float2 const> const> contours,
+                 std::span<uint32_t const> params,
+                 std::pmr::memory_resource* memory):
+    geometry(memory ? memory : std::pmr::get_default_resource()),
+    params(params.begin(), params.end(), geometry.get_allocator()) {
+    auto first = std::ranges::find_if(contours, [](auto contour) {
+        return !contour.empty();
+    });
+    if (first != contours.end()) {
+        _origin = first->front();
+    }
+    size_t numPoints = 0;
+    for (auto contour: contours) {
+        numPoints += contour.size();
+    }
+    geometry.reserve(numPoints);
+    this->params.reserve(params.size() + contours.size());
+    for (auto contour: contours) {
+        this->params.push_back((uint32_t)contour.size());
+        for (auto p: contour) {
+            geometry.push_back(p - _origin);
+        }
+    }
+    _hash = 0xcbf29ce484222325;
+    for (uint32_t param: this->params) {
+        hashWord(_hash, param);
+    }
+    for (auto p: geometry) {
+        // Adding zero maps -0 to +0 so equal points hash equally
+        hashWord(_hash, std::bit_cast<uint32_t>(p.x + 0.0f));
+        hashWord(_hash, std::bit_cast<uint32_t>(p.y + 0.0f));
+    }
+}
+
+CachedMesh const* MeshCache::find(MeshKey const& key) {
+    auto itr = entries.find(key);
+    if (itr == entries.end()) {
+        return nullptr;
+    }
+    itr->second.used = true;
+    return &itr->second.mesh;
+}
+
+void MeshCache::insert(MeshKey const& key,
+                       std::span<vml::float2 const> vertices,
+                       std::span<float const> coverage,
+                       std::span<uint32_t const> indices) {
+    CachedMesh mesh;
+    mesh.vertices.reserve(vertices.size());
+    for (auto v: vertices) {
+        mesh.vertices.push_back(v - key.origin());
+    }
+    mesh.coverage.assign(coverage.begin(), coverage.end());
+    mesh.indices.assign(indices.begin(), indices.end());
+    entries.insert_or_assign(key, Entry{ std::move(mesh) });
+}
+
+void MeshCache::collect() {
+    std::erase_if(entries, [](auto& entry) { return !entry.second.used; });
+    for (auto& [key, entry]: entries) {
+        entry.used = false;
+    }
+}
@@ -2,17 +2,130 @@
 
 #include <algorithm>
 #include <alloca.h>
+#include <bit>
 #include <cassert>
+#include <cmath>
 #include <concepts>
-#include <iostream>
+#include <memory_resource>
+#include <numeric>
 #include <ranges>
+#include <set>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
-#include <utl/stack.hpp>
-
 using namespace xui;
 
+/// \Returns \p scratch or the default memory resource if it is null
+static std::pmr::memory_resource* scratchResource(
+    std::pmr::memory_resource* scratch) {
+    return scratch ? scratch : std::pmr::get_default_resource();
+}
+
+/// Upper bound for the number of segments computed from a flatness tolerance
+static constexpr int MaxAdaptiveSegments = 1024;
+
+/// Computes the number of segments needed to flatten the Bezier curve with
+/// control points `[begin, end)` such that the flattened path deviates from the
+/// curve by at most \p tolerance. This is Wang's formula, see "The NURBS Book"
+/// by Piegl and Tiller
+template <typename FloatType = float, std::random_access_iterator Itr,
+          std::sentinel_for<Itr> S>
+static int bezierSegmentCount(Itr begin, S end, FloatType tolerance) {
+    size_t count = std::ranges::distance(begin, end);
+    if (count < 3) {
+        return 1;
+    }
+    FloatType maxLength = 0;
+    for (size_t i = 0; i + 2 < count; ++i) {
+        auto d = begin[i] - FloatType(2) * begin[i + 1] + begin[i + 2];
+        maxLength = std::max(maxLength, FloatType(std::sqrt(dot(d, d))));
+    }
+    FloatType degree = FloatType(count - 1);
+    FloatType n =
+        std::sqrt(degree * (degree - 1) * maxLength / (8 * tolerance));
+    return std::clamp(int(std::ceil(n)), 1, MaxAdaptiveSegments);
+}
+
+/// Computes the number of segments needed to flatten a circular arc such that
+/// the sagitta of each segment is at most \p tolerance
+template <typename FloatType>
+static int circleSegmentCount(FloatType radius, FloatType angle,
+                              FloatType tolerance) {
+    FloatType cosHalfStep = std::clamp(1 - tolerance / radius, FloatType(-1),
+                                       FloatType(1));
+    FloatType step = 2 * std::acos(cosHalfStep);
+    if (!(step > 0)) {
+        return MaxAdaptiveSegments;
+    }
+    return std::clamp(int(std::ceil(std::abs(angle) / step)), 1,
+                      MaxAdaptiveSegments);
+}
+
+/// Number of segments a Bezier curve with control points `[begin, end)` is
+/// flattened into
+template <typename FloatType = float, std::random_access_iterator Itr,
+          std::sentinel_for<Itr> S>
+static int bezierNumSegments(Itr begin, S end, BezierOptions const& options) {
+    if (options.tolerance > 0) {
+        return bezierSegmentCount<FloatType>(begin, end,
+                                             options.tolerance / options.scale);
+    }
+    return options.numSegments;
+}
+
+namespace {
+
+/// Coefficients of a Bezier curve of degree three or less in power basis, i.e.,
+/// `p(t) = ((a * t + b) * t + c) * t + d`
+template <typename FloatType>
+struct PowerBasisCurve {
+    vml::vector2<FloatType> a, b, c, d;
+};
+
+} // namespace
+
+/// Converts the control points of a linear, quadratic or cubic Bezier curve to
+/// power basis
+template <typename FloatType, std::random_access_iterator Itr>
+static PowerBasisCurve<FloatType> toPowerBasis(Itr cp, size_t count) {
+    using VecType = vml::vector2<FloatType>;
+    switch (count) {
+    case 2:
+        return { VecType(0), VecType(0), cp[1] - cp[0], cp[0] };
+    case 3:
+        return { VecType(0), cp[0] - FloatType(2) * cp[1] + cp[2],
+                 FloatType(2) * (cp[1] - cp[0]), cp[0] };
+    case 4:
+        return { cp[3] - cp[0] + FloatType(3) * (cp[1] - cp[2]),
+                 FloatType(3) * (cp[0] - FloatType(2) * cp[1] + cp[2]),
+                 FloatType(3) * (cp[1] - cp[0]), cp[0] };
+    default:
+        assert(false);
+        return {};
+    }
+}
+
+/// Evaluates \p curve at the samples `first, ..., last` of a subdivision into
+/// \p numSegments segments. Each sample costs three multiply-adds per
+/// component and samples are independent of each other, so when \p output
+/// stores into contiguous memory the loop can be vectorized. The end point is
+/// emitted exactly as \p endPoint so adjacent curves join without cracks
+template <typename FloatType, typename Output>
+static void samplePowerBasis(PowerBasisCurve<FloatType> const& curve,
+                             vml::vector2<FloatType> endPoint, int numSegments,
+                             int first, int last, Output output) {
+    FloatType dt = FloatType(1) / numSegments;
+    int lastInterior = std::min(last, numSegments - 1);
+    for (int s = first; s <= lastInterior; ++s) {
+        FloatType t = FloatType(s) * dt;
+        output(((curve.a * t + curve.b) * t + curve.c) * t + curve.d);
+    }
+    if (last == numSegments) {
+        output(endPoint);
+    }
+}
+
 template <typename FloatType = float, std::random_access_iterator Itr,
           std::sentinel_for<Itr> S,
           std::invocable<vml::vector2<FloatType>> VertexEmitter>
@@ -20,10 +133,23 @@ static void pathBezierImpl(Itr begin, S end, VertexEmitter vertexEmitter,
                            BezierOptions options) {
     using VecType = vml::vector2<FloatType>;
     size_t count = std::distance(begin, end);
+    if (count == 0) {
+        return;
+    }
+    int numSegments = bezierNumSegments<FloatType>(begin, end, options);
+    int first = options.emitFirstPoint ? 0 : 1;
+    int last = numSegments - (options.emitLastPoint ? 0 : 1);
+    // Curves up to degree three are evaluated in power basis
+    if (count >= 2 && count <= 4) {
+        samplePowerBasis(toPowerBasis<FloatType>(begin, count),
+                         VecType(begin[count - 1]), numSegments, first, last,
+                         [&](VecType p) { std::invoke(vertexEmitter, p); });
+        return;
+    }
+    // Higher degree curves fall back to de Casteljau's algorithm
     VecType* data = (VecType*)alloca(count * sizeof(VecType));
-    int numIterations = options.numSegments - (options.emitLastPoint ? 0 : 1);
-    for (int s = options.emitFirstPoint ? 0 : 1; s <= numIterations; ++s) {
-        FloatType t = FloatType(s) / options.numSegments;
+    for (int s = first; s <= last; ++s) {
+        FloatType t = FloatType(s) / numSegments;
         std::ranges::copy(begin, end, data);
         for (size_t j = 1; j < count; ++j) {
             for (size_t i = 0; i < count - j; ++i) {
@@ -41,6 +167,43 @@ void xui::pathBezier(std::span<vml::float2 const> controlPoints,
                           vertexEmitter, options);
 }
 
+size_t xui::bezierVertexCount(std::span<vml::float2 const> controlPoints,
+                              BezierOptions options) {
+    if (controlPoints.empty()) {
+        return 0;
+    }
+    int numSegments = bezierNumSegments(controlPoints.begin(),
+                                        controlPoints.end(), options);
+    int count = numSegments + 1 - !options.emitFirstPoint -
+                !options.emitLastPoint;
+    return (size_t)std::max(count, 0);
+}
+
+size_t xui::pathBeziers(std::span<CubicBezier const> curves,
+                        std::span<vml::float2> vertices,
+                        std::span<size_t> ends, BezierOptions options) {
+    assert(ends.empty() || ends.size() >= curves.size());
+    int first = options.emitFirstPoint ? 0 : 1;
+    size_t index = 0;
+    for (size_t i = 0; i < curves.size(); ++i) {
+        auto& curve = curves[i];
+        int numSegments = bezierNumSegments(curve.begin(), curve.end(),
+                                            options);
+        int last = numSegments - (options.emitLastPoint ? 0 : 1);
+        size_t count = (size_t)std::max(last - first + 1, 0);
+        assert(index + count <= vertices.size() && "Output span is too small");
+        vml::float2* out = vertices.data() + index;
+        samplePowerBasis(toPowerBasis<float>(curve.begin(), 4), curve[3],
+                         numSegments, first, last,
+                         [&](vml::float2 p) { *out++ = p; });
+        index += count;
+        if (!ends.empty()) {
+            ends[i] = index;
+        }
+    }
+    return index;
+}
+
 template <typename FloatType = float,
           std::invocable<vml::vector2<FloatType>> VertexEmitter>
 static void pathCircleSegmentImpl(vml::vector2<FloatType> begin,
@@ -48,13 +211,17 @@ static void pathCircleSegmentImpl(vml::vector2<FloatType> begin,
                                   FloatType totalAngle,
                                   VertexEmitter vertexEmitter,
                                   CircleSegmentOptions options = {}) {
-    int end = options.numSegments - (options.emitLast ? 0 : 1);
+    auto v = begin - origin;
+    int numSegments =
+        options.tolerance > 0 ?
+            circleSegmentCount<FloatType>(std::sqrt(dot(v, v)), totalAngle,
+                                          options.tolerance / options.scale) :
+            options.numSegments;
+    int end = numSegments - (options.emitLast ? 0 : 1);
     int orientation = options.orientation == Orientation::Counterclockwise ? 1 :
                                                                              -1;
-    auto v = begin - origin;
     for (int i = options.emitFirst ? 0 : 1; i <= end; ++i) {
-        FloatType angle =
-            orientation * totalAngle * FloatType(i) / options.numSegments;
+        FloatType angle = orientation * totalAngle * FloatType(i) / numSegments;
         std::invoke(vertexEmitter, origin + vml::rotate(v, angle));
     }
 }
@@ -70,14 +237,15 @@ template <std::unsigned_integral IndexType = uint32_t,
           typename FloatType = float, std::random_access_iterator Itr,
           std::sentinel_for<Itr> S, std::invocable<vml::float2> VertexEmitter,
           std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
-static void buildLineMeshImpl(Itr begin, S end, VertexEmitter vertexEmitter,
-                              TriangleEmitter triangleEmitter,
-                              LineMeshOptions options) {
+static void buildSolidLineMeshImpl(Itr begin, S end,
+                                   VertexEmitter vertexEmitter,
+                                   TriangleEmitter triangleEmitter,
+                                   LineMeshOptions options) {
     using VecType = vml::vector2<FloatType>;
-    if (begin == end) {
+    size_t numPoints = std::ranges::distance(begin, end);
+    if (numPoints < 2) {
         return;
     }
-    size_t numPoints = std::ranges::distance(begin, end);
     auto lastItr = begin + numPoints - 1;
     IndexType numVertices = 0;
     auto emitVertex = [&vertexEmitter, &numVertices](VecType position,
@@ -94,80 +262,338 @@ static void buildLineMeshImpl(Itr begin, S end, VertexEmitter vertexEmitter,
                                            IndexType c) {
         std::invoke(triangleEmitter, a, b, c);
     };
-    auto rotate = [](vml::float2 v) { return VecType(v.y, -v.x); };
-    auto emitQuad = [&](IndexType a, IndexType b, IndexType c, IndexType d) {
+    auto rotate = [](VecType v) { return VecType(v.y, -v.x); };
+    // Two vertices on opposite sides of the line. `a` is offset along the
+    // normal of the segment, `b` against it
+    struct VertexPair {
+        IndexType a, b;
+    };
+    auto emitQuad = [&](VertexPair from, VertexPair to) {
         // a -- b
         // |  / |
         // | /  |
         // c -- d
-        emitTriangle(b, a, c);
-        emitTriangle(b, c, d);
+        emitTriangle(from.b, from.a, to.a);
+        emitTriangle(from.b, to.a, to.b);
     };
-    VecType lastSegNormal = [&] {
-        if (options.closed) {
-            auto tangent = normalize(*begin - *lastItr);
-            return rotate(tangent);
-        }
-        else {
-            return VecType{ 0, 0 };
-        }
-    }();
-    auto emitVertices = [&](size_t pointIndex, auto point, auto tangent) {
-        VecType segNormal = rotate(tangent);
-        VecType normal = normalize(segNormal + lastSegNormal);
-        auto cosAlpha = dot(segNormal, normal);
-        auto normalLen = (options.width / 2) / cosAlpha;
-        VecType offset = normalLen * normal;
-        lastSegNormal = segNormal;
+    FloatType halfWidth = options.width / 2;
+    auto emitPair = [&](size_t pointIndex, VecType point, VecType offset) {
+        IndexType index = numVertices;
         emitVertex(point + offset, pointIndex);
         emitVertex(point - offset, pointIndex);
+        return VertexPair{ index, IndexType(index + 1) };
     };
-    auto i = begin;
-    size_t pointIndex = 0;
-    while (true) {
-        auto next = std::next(i);
-        if (next == end) {
-            break;
+    // Direction and length of the segment from point `i` to its successor
+    auto segment = [&](size_t i) {
+        VecType d = VecType(begin[(i + 1) % numPoints]) - VecType(begin[i]);
+        FloatType length = std::sqrt(dot(d, d));
+        return std::pair{ d / length, length };
+    };
+    // Emits the vertices of the join at `point` between the segments with
+    // directions `t0` and `t1` and lengths `len0` and `len1`. Returns the
+    // vertex pairs where the incoming segment ends and where the outgoing
+    // segment begins
+    auto emitJoin = [&](size_t pointIndex, VecType point, VecType t0,
+                        FloatType len0, VecType t1, FloatType len1) {
+        VecType n0 = rotate(t0);
+        VecType n1 = rotate(t1);
+        VecType sum = n0 + n1;
+        FloatType sumLength = std::sqrt(dot(sum, sum));
+        // Cosine of half the angle the line turns by
+        FloatType cosHalfTurn = sumLength / 2;
+        FloatType const eps = FloatType(1e-4);
+        VecType miterDir = sumLength > eps ? sum / sumLength : n0;
+        // On the inner side both segments can share the miter point if it lies
+        // on both segments. Otherwise, i.e., at sharp turns of short segments,
+        // the segments overlap on the inner side and the join is fanned around
+        // the point itself
+        FloatType sinHalfTurn =
+            std::sqrt(std::max(FloatType(0), 1 - cosHalfTurn * cosHalfTurn));
+        bool shareInner = sumLength > eps && halfWidth * sinHalfTurn <=
+                                                 std::min(len0, len1) *
+                                                     cosHalfTurn;
+        bool useMiter =
+            options.join.style == LineJoinOptions::Miter &&
+            (cosHalfTurn > 1 - eps ||
+             (shareInner &&
+              cosHalfTurn * options.join.miterLimit >= FloatType(1)));
+        if (useMiter) {
+            auto pair =
+                emitPair(pointIndex, point, halfWidth / cosHalfTurn * miterDir);
+            return std::pair{ pair, pair };
+        }
+        // The outer side of the join is along the normal if the line turns
+        // away from the normal
+        FloatType side = dot(t1, n0) > 0 ? -1 : 1;
+        VecType outerMid = sumLength > eps ? side * miterDir : t0;
+        VecType outerBegin = side * n0;
+        IndexType outer0 = numVertices;
+        emitVertex(point + halfWidth * outerBegin, pointIndex);
+        IndexType inner0 = numVertices, pivot = numVertices;
+        if (shareInner) {
+            emitVertex(point - halfWidth / cosHalfTurn * outerMid, pointIndex);
+        }
+        else {
+            emitVertex(point - halfWidth * outerBegin, pointIndex);
+            pivot = numVertices;
+            emitVertex(point, pointIndex);
+        }
+        IndexType last = outer0;
+        if (options.join.style == LineJoinOptions::Round) {
+            FloatType angle =
+                std::acos(std::clamp(dot(t0, t1), FloatType(-1), FloatType(1)));
+            int numArcSegments = std::max(
+                1, int(std::ceil(angle / FloatType(M_PI) *
+                                 std::max(options.join.numSegments, 1))));
+            // Rotate from the outer normal of the incoming segment towards the
+            // outer normal of the outgoing segment
+            FloatType cross =
+                outerBegin.x * outerMid.y - outerBegin.y * outerMid.x;
+            FloatType step = (cross >= 0 ? 1 : -1) * angle / numArcSegments;
+            FloatType c = std::cos(step), s = std::sin(step);
+            VecType dir = outerBegin;
+            for (int i = 1; i < numArcSegments; ++i) {
+                dir = VecType(c * dir.x - s * dir.y, s * dir.x + c * dir.y);
+                IndexType index = numVertices;
+                emitVertex(point + halfWidth * dir, pointIndex);
+                emitTriangle(pivot, last, index);
+                last = index;
+            }
+        }
+        IndexType outer1 = numVertices;
+        emitVertex(point + halfWidth * side * n1, pointIndex);
+        emitTriangle(pivot, last, outer1);
+        IndexType inner1 = inner0;
+        if (!shareInner) {
+            inner1 = numVertices;
+            emitVertex(point - halfWidth * side * n1, pointIndex);
         }
-        emitQuad(numVertices, numVertices + 1, numVertices + 2,
-                 numVertices + 3);
-        emitVertices(pointIndex, *i, normalize(*next - *i));
-        i = next;
-        ++pointIndex;
+        if (side > 0) {
+            return std::pair{ VertexPair{ outer0, inner0 },
+                              VertexPair{ outer1, inner1 } };
+        }
+        return std::pair{ VertexPair{ inner0, outer0 },
+                          VertexPair{ inner1, outer1 } };
+    };
+    VertexPair firstIn{}, lastOut{};
+    for (size_t i = 0; i < numPoints; ++i) {
+        bool hasIn = options.closed || i > 0;
+        bool hasOut = options.closed || i + 1 < numPoints;
+        VecType point = begin[i];
+        std::pair<VertexPair, VertexPair> pairs;
+        if (hasIn && hasOut) {
+            auto [t0, len0] = segment((i + numPoints - 1) % numPoints);
+            auto [t1, len1] = segment(i);
+            pairs = emitJoin(i, point, t0, len0, t1, len1);
+        }
+        else {
+            auto t = segment(hasOut ? i : i - 1).first;
+            auto pair = emitPair(i, point, halfWidth * rotate(t));
+            pairs = { pair, pair };
+        }
+        if (i == 0) {
+            firstIn = pairs.first;
+        }
+        else {
+            emitQuad(lastOut, pairs.first);
+        }
+        lastOut = pairs.second;
     }
     if (options.closed) {
-        emitQuad(numVertices, numVertices + 1, 0, 1);
-        emitVertices(pointIndex, *i, normalize(*begin - *i));
+        emitQuad(lastOut, firstIn);
         return;
     }
-    emitVertices(pointIndex, *i, normalize(*i - *(i - 1)));
     auto generateCap = [&](LineCapOptions const& cap, size_t pointIndex,
                            VecType point, VecType tangent, IndexType idxA,
                            IndexType idxB) {
         switch (cap.style) {
         case LineCapOptions::None:
             return;
-        case LineCapOptions::Circle:
+        case LineCapOptions::Circle: {
+            if (cap.numSegments <= 0) {
+                return;
+            }
             emitTriangle(idxA, idxB, numVertices);
+            // We rotate the direction incrementally to avoid evaluating sin
+            // and cos for every cap vertex
+            FloatType step = FloatType(M_PI) / (cap.numSegments + 1);
+            auto stepRotation = vml::make_rotation2x2(step);
+            VecType dir =
+                vml::make_rotation2x2(step - FloatType(M_PI / 2)) * tangent;
             for (int i = 0; i < cap.numSegments; ++i) {
-                FloatType angle =
-                    M_PI * (FloatType(i + 1) / (cap.numSegments + 1) - 0.5);
-                auto mat = vml::make_rotation2x2(angle);
-                emitVertex(point + options.width / 2 * (mat * tangent),
-                           pointIndex);
+                emitVertex(point + options.width / 2 * dir, pointIndex);
+                dir = stepRotation * dir;
                 if (i != cap.numSegments - 1) {
                     emitTriangle(numVertices - 1, idxB, numVertices);
                 }
             }
             return;
         }
+        }
     };
-    IndexType numSegmentVertices = numVertices;
     generateCap(options.beginCap, 0, *begin,
-                normalize(*begin - *std::next(begin)), 0, 1);
+                normalize(*begin - *std::next(begin)), firstIn.a, firstIn.b);
     generateCap(options.endCap, numPoints, *lastItr,
-                normalize(*lastItr - *(lastItr - 1)), numSegmentVertices - 1,
-                numSegmentVertices - 2);
+                normalize(*lastItr - *(lastItr - 1)), lastOut.b, lastOut.a);
+}
+
+/// \Returns the length of one period of the dash pattern \p dash. A pattern
+/// with an odd number of entries is repeated twice
+template <typename FloatType = float>
+static FloatType dashPatternLength(LineDashOptions const& dash) {
+    FloatType length = 0;
+    for (float entry: dash.pattern) {
+        length += std::max(FloatType(entry), FloatType(0));
+    }
+    return dash.pattern.size() % 2 == 0 ? length : 2 * length;
+}
+
+/// \Returns true if \p dash has a pattern with positive length
+static bool isDashed(LineDashOptions const& dash) {
+    return !dash.pattern.empty() && dashPatternLength(dash) > 0;
+}
+
+/// Splits the line `[begin, begin + numPoints)` into dashes according to
+/// \p dash and invokes \p callback with the points of every dash of positive
+/// length and whether the dash is closed. A dash is only closed if the line is
+/// closed and the pattern never switches to a gap. The points of the dashes
+/// are stored in memory from \p scratch
+template <typename FloatType = float, std::random_access_iterator Itr>
+static void forEachDash(Itr begin, size_t numPoints, bool closed,
+                        LineDashOptions const& dash,
+                        std::pmr::memory_resource* scratch, auto callback) {
+    using VecType = vml::vector2<FloatType>;
+    FloatType patternLength = dashPatternLength<FloatType>(dash);
+    if (numPoints < 2 || !(patternLength > 0)) {
+        return;
+    }
+    size_t patternSize = dash.pattern.size() % 2 == 0 ? dash.pattern.size() :
+                                                        2 * dash.pattern.size();
+    auto patternAt = [&](size_t index) {
+        return std::max(FloatType(dash.pattern[index % dash.pattern.size()]),
+                        FloatType(0));
+    };
+    // Find the pattern entry and the distance remaining in it at the
+    // beginning of the line
+    FloatType phase = std::fmod(FloatType(dash.phase), patternLength);
+    if (phase < 0) {
+        phase += patternLength;
+    }
+    size_t index = 0;
+    for (size_t i = 0; i < patternSize && phase >= patternAt(index); ++i) {
+        phase -= patternAt(index);
+        index = (index + 1) % patternSize;
+    }
+    FloatType remaining = std::max(patternAt(index) - phase, FloatType(0));
+    bool on = index % 2 == 0;
+    bool beganOn = on;
+    // The points of all dashes are stored back to back, `ends` holds the end
+    // of each dash
+    std::pmr::vector<VecType> points(scratchResource(scratch));
+    std::pmr::vector<size_t> ends(scratchResource(scratch));
+    if (on) {
+        points.push_back(begin[0]);
+    }
+    size_t numSegments = closed ? numPoints : numPoints - 1;
+    for (size_t s = 0; s < numSegments; ++s) {
+        VecType a = begin[s];
+        VecType b = begin[(s + 1) % numPoints];
+        VecType d = b - a;
+        FloatType length = std::sqrt(dot(d, d));
+        FloatType t = 0;
+        while (length - t > remaining) {
+            t += remaining;
+            // A dash that ends at the beginning of the segment already ends
+            // with `a`
+            if (!on || t > 0) {
+                points.push_back(a + d * (t / length));
+            }
+            if (on) {
+                ends.push_back(points.size());
+            }
+            on = !on;
+            index = (index + 1) % patternSize;
+            remaining = patternAt(index);
+        }
+        remaining -= length - t;
+        if (on && length > 0) {
+            points.push_back(b);
+        }
+    }
+    if (on) {
+        ends.push_back(points.size());
+    }
+    auto emit = [&](std::span<VecType const> dashPoints, bool closedDash) {
+        VecType front = dashPoints.front();
+        bool hasLength = std::ranges::any_of(dashPoints, [&](VecType p) {
+            return p.x != front.x || p.y != front.y;
+        });
+        if (dashPoints.size() >= 2 && hasLength) {
+            callback(dashPoints, closedDash);
+        }
+    };
+    if (closed && beganOn && on) {
+        // The line is closed and the first and the last dash meet at the first
+        // point, so we emit them as one dash
+        if (ends.size() == 1) {
+            emit(std::span(points).first(points.size() - 1), true);
+            return;
+        }
+        std::pmr::vector<VecType> merged(points.begin() +
+                                             ends[ends.size() - 2],
+                                         points.end(), points.get_allocator());
+        merged.insert(merged.end(), points.begin() + 1,
+                      points.begin() + ends[0]);
+        emit(merged, false);
+        ends.pop_back();
+        for (size_t i = 1; i < ends.size(); ++i) {
+            emit(std::span(points).subspan(ends[i - 1], ends[i] - ends[i - 1]),
+                 false);
+        }
+        return;
+    }
+    for (size_t i = 0; i < ends.size(); ++i) {
+        size_t first = i > 0 ? ends[i - 1] : 0;
+        emit(std::span(points).subspan(first, ends[i] - first), false);
+    }
+}
+
+template <std::unsigned_integral IndexType = uint32_t,
+          typename FloatType = float, std::random_access_iterator Itr,
+          std::sentinel_for<Itr> S, std::invocable<vml::float2> VertexEmitter,
+          std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
+static void buildLineMeshImpl(Itr begin, S end, VertexEmitter vertexEmitter,
+                              TriangleEmitter triangleEmitter,
+                              LineMeshOptions options) {
+    using VecType = vml::vector2<FloatType>;
+    if (!isDashed(options.dash)) {
+        buildSolidLineMeshImpl<IndexType, FloatType>(begin, end, vertexEmitter,
+                                                     triangleEmitter, options);
+        return;
+    }
+    // Every dash is built as a solid line with its own caps. Indices are
+    // offset by the vertices of the preceding dashes
+    LineMeshOptions dashOptions = options;
+    dashOptions.dash = {};
+    IndexType numVertices = 0, baseVertex = 0;
+    auto emitVertex = [&](VecType p) {
+        std::invoke(vertexEmitter, p);
+        ++numVertices;
+    };
+    auto emitTriangle = [&](IndexType a, IndexType b, IndexType c) {
+        std::invoke(triangleEmitter, baseVertex + a, baseVertex + b,
+                    baseVertex + c);
+    };
+    auto buildDash = [&](std::span<VecType const> dash, bool closed) {
+        dashOptions.closed = closed;
+        baseVertex = numVertices;
+        buildSolidLineMeshImpl<IndexType, FloatType>(dash.begin(), dash.end(),
+                                                     emitVertex, emitTriangle,
+                                                     dashOptions);
+    };
+    forEachDash<FloatType>(begin, std::ranges::distance(begin, end),
+                           options.closed, options.dash, options.scratch,
+                           buildDash);
 }
 
 void xui::buildLineMesh(
@@ -179,46 +605,115 @@ void xui::buildLineMesh(
                       options);
 }
 
-template <typename VecType>
-static auto signedArea(VecType p1, VecType p2, VecType p3) {
-    return (p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x);
+/// Exact number of vertices and indices of the line mesh of a solid line
+static MeshSize solidLineMeshSize(size_t numPoints,
+                                  LineMeshOptions const& options) {
+    if (numPoints < 2) {
+        return {};
+    }
+    size_t numSegments = numPoints - !options.closed;
+    size_t numJoins = options.closed ? numPoints : numPoints - 2;
+    size_t numEnds = numPoints - numJoins;
+    // Miter joins that exceed the miter limit are beveled, so all join styles
+    // may emit up to three extra vertices and a triangle
+    size_t joinVertices = 5, joinIndices = 3;
+    if (options.join.style == LineJoinOptions::Round) {
+        size_t numArcSegments = std::max(options.join.numSegments, 1);
+        joinVertices = numArcSegments + 4;
+        joinIndices = 3 * numArcSegments;
+    }
+    MeshSize size = { .numVertices = 2 * numEnds + joinVertices * numJoins,
+                      .numIndices = 6 * numSegments + joinIndices * numJoins };
+    if (options.closed) {
+        return size;
+    }
+    for (auto& cap: { options.beginCap, options.endCap }) {
+        if (cap.style == LineCapOptions::Circle && cap.numSegments > 0) {
+            size.numVertices += cap.numSegments;
+            size.numIndices += 3 * cap.numSegments;
+        }
+    }
+    return size;
 }
 
-template <typename VecType>
-static bool isPointInTriangle(VecType p, VecType a, VecType b, VecType c) {
-    auto area1 = signedArea(p, a, b);
-    auto area2 = signedArea(p, b, c);
-    auto area3 = signedArea(p, c, a);
-    return (area1 > 0 && area2 > 0 && area3 > 0) ||
-           (area1 < 0 && area2 < 0 && area3 < 0);
+MeshSize xui::lineMeshSize(std::span<vml::float2 const> line,
+                           LineMeshOptions const& options) {
+    if (!isDashed(options.dash)) {
+        return solidLineMeshSize(line.size(), options);
+    }
+    MeshSize size;
+    forEachDash(line.begin(), line.size(), options.closed, options.dash,
+                options.scratch,
+                [&](std::span<vml::float2 const> dash, bool closed) {
+        LineMeshOptions dashOptions = options;
+        dashOptions.closed = closed;
+        auto dashSize = solidLineMeshSize(dash.size(), dashOptions);
+        size.numVertices += dashSize.numVertices;
+        size.numIndices += dashSize.numIndices;
+    });
+    return size;
+}
+
+namespace {
+
+/// Emitter that writes indices into a span. Triangles that exceed the capacity
+/// of the span are dropped, this only happens for invalid input
+struct IndexWriter {
+    uint32_t* data;
+    size_t capacity;
+    size_t size = 0;
+
+    void operator()(uint32_t a, uint32_t b, uint32_t c) {
+        if (size + 3 > capacity) {
+            assert(false && "Index buffer is too small");
+            return;
+        }
+        data[size++] = a;
+        data[size++] = b;
+        data[size++] = c;
+    }
+};
+
+} // namespace
+
+MeshSize xui::buildLineMeshInto(std::span<vml::float2 const> line,
+                                std::span<vml::float2> vertices,
+                                std::span<uint32_t> indices,
+                                LineMeshOptions options) {
+    assert(vertices.size() >= lineMeshSize(line, options).numVertices);
+    size_t numVertices = 0;
+    IndexWriter indexWriter{ indices.data(), indices.size() };
+    buildLineMeshImpl(
+        line.begin(), line.end(),
+        [&](vml::float2 p) { vertices[numVertices++] = p; },
+        [&](uint32_t a, uint32_t b, uint32_t c) { indexWriter(a, b, c); },
+        options);
+    return { numVertices, indexWriter.size };
 }
 
 template <typename VecType>
-static bool isConvex(VecType prev, VecType curr, VecType next) {
-    return signedArea(prev, curr, next) > 0;
+static auto signedArea(VecType p1, VecType p2, VecType p3) {
+    return (p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x);
 }
 
-static bool isEar(auto begin, auto end, size_t prev, size_t curr, size_t next) {
-    if (!isConvex(*(begin + prev), *(begin + curr), *(begin + next))) {
-        return false;
+/// Twice the signed area of the polygon formed by \p indices. The area is
+/// positive if the polygon is oriented clockwise in screen coordinates (Y axis
+/// pointing down)
+static double polygonSignedArea(
+    std::ranges::random_access_range auto&& indices, auto vertexAt) {
+    double area = 0;
+    for (size_t i = 0, n = std::ranges::size(indices); i < n; ++i) {
+        auto a = vertexAt(indices[i]);
+        auto b = vertexAt(indices[(i + 1) % n]);
+        area += double(a.x) * double(b.y) - double(b.x) * double(a.y);
     }
-    size_t i = 0;
-    for (auto itr = begin; itr != end; ++itr, ++i) {
-        if (i == prev || i == curr || i == next) {
-            continue;
-        }
-        if (isPointInTriangle(*(begin + i), *(begin + prev), *(begin + curr),
-                              *(begin + next)))
-        {
-            return false;
-        }
-    }
-    return true;
+    return area;
 }
 
 template <typename IndexType>
-static std::vector<IndexType> makeIndexVector(size_t vertexCount) {
-    std::vector<IndexType> indices;
+static std::pmr::vector<IndexType> makeIndexVector(
+    size_t vertexCount, std::pmr::memory_resource* scratch) {
+    std::pmr::vector<IndexType> indices(scratch);
     indices.reserve(vertexCount);
     for (IndexType i = 0; i < vertexCount; ++i) {
         indices.push_back(i);
@@ -226,32 +721,30 @@ static std::vector<IndexType> makeIndexVector(size_t vertexCount) {
     return indices;
 }
 
-template <std::unsigned_integral IndexType = uint32_t, std::input_iterator Itr,
-          std::sentinel_for<Itr> S,
-          std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
-void static triangulatePolyEarClipping(Itr begin, S end,
-                                       TriangleEmitter triangleEmitter) {
-    size_t vertexCount = std::ranges::distance(begin, end);
-    std::vector<IndexType> vertexIndices =
-        makeIndexVector<IndexType>(vertexCount);
-loopBegin:
-    while (vertexIndices.size() > 3) {
-        size_t n = vertexIndices.size();
-        for (size_t i = 0; i < n; ++i) {
-            IndexType prev = vertexIndices[(i + n - 1) % n];
-            IndexType curr = vertexIndices[i];
-            IndexType next = vertexIndices[(i + 1) % n];
-            if (isEar(begin, end, prev, curr, next)) {
-                std::invoke(triangleEmitter, prev, curr, next);
-                vertexIndices.erase(vertexIndices.begin() + i);
-                goto loopBegin;
-            }
+/// Appends the vertex indices \p indices of a closed contour to \p polygon.
+/// Indices whose vertex equals the previously appended one and trailing
+/// indices whose vertex equals the first are skipped, because the zero length
+/// edges they form break the sweep. \Returns the number of appended indices
+template <std::unsigned_integral IndexType>
+static size_t appendContour(std::pmr::vector<IndexType>& polygon,
+                            std::ranges::input_range auto&& indices,
+                            auto vertexAt) {
+    auto samePosition = [&](IndexType a, IndexType b) {
+        auto p = vertexAt(a), q = vertexAt(b);
+        return p.x == q.x && p.y == q.y;
+    };
+    size_t begin = polygon.size();
+    for (IndexType index: indices) {
+        if (polygon.size() == begin || !samePosition(polygon.back(), index)) {
+            polygon.push_back(index);
         }
-        std::cerr << "No ear found, possibly degenerate polygon\n";
-        return;
     }
-    std::invoke(triangleEmitter, vertexIndices[0], vertexIndices[1],
-                vertexIndices[2]);
+    while (polygon.size() > begin + 1 &&
+           samePosition(polygon.back(), polygon[begin]))
+    {
+        polygon.pop_back();
+    }
+    return polygon.size() - begin;
 }
 
 template <std::unsigned_integral IndexType>
@@ -260,74 +753,648 @@ bool is_distance_one_mod_n(IndexType a, IndexType b, size_t n) {
     return diff == 1 || diff == n - 1;
 }
 
-template <std::unsigned_integral IndexType = uint32_t, std::input_iterator Itr,
-          std::sentinel_for<Itr> S,
+/// Triangulates the Y monotone polygon formed by the vertex indices
+/// \p polygon. Emitted triangles refer to the values in \p polygon
+template <std::unsigned_integral IndexType = uint32_t,
           std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
-void static triangulatePolyYMonotone(Itr begin, S end,
-                                     TriangleEmitter triangleEmitter,
-                                     Orientation orientation) {
-    size_t vertexCount = std::ranges::distance(begin, end);
+static void triangulatePolyYMonotoneImpl(std::span<IndexType const> polygon,
+                                         auto vertexAt,
+                                         TriangleEmitter triangleEmitter,
+                                         Orientation orientation,
+                                         std::pmr::memory_resource* scratch) {
+    size_t vertexCount = polygon.size();
     assert(vertexCount >= 3);
-    std::vector<IndexType> vertexIndices =
-        makeIndexVector<IndexType>(vertexCount);
-    auto vertexAt = [begin](IndexType index) -> auto& {
-        return *(begin + index);
+    std::pmr::vector<IndexType> vertexIndices =
+        makeIndexVector<IndexType>(vertexCount, scratch);
+    auto positionAt = [&](IndexType index) {
+        return vertexAt(polygon[index]);
+    };
+    auto emitTriangle = [&](IndexType a, IndexType b, IndexType c) {
+        std::invoke(triangleEmitter, polygon[a], polygon[b], polygon[c]);
     };
     auto isConvex = [&](IndexType a, IndexType b, IndexType c) -> bool {
-        auto p1 = vertexAt(a);
-        auto p2 = vertexAt(b);
-        auto p3 = vertexAt(c);
-        return (p2.x - p1.x) * (p3.y - p1.y) - (p2.y - p1.y) * (p3.x - p1.x) >
-               0;
+        return signedArea(positionAt(a), positionAt(b), positionAt(c)) > 0;
     };
     auto compare = [&](IndexType i, IndexType j) {
-        auto a = vertexAt(i);
-        auto b = vertexAt(j);
+        auto a = positionAt(i);
+        auto b = positionAt(j);
         return a.y == b.y ? a.x < b.x : a.y < b.y;
     };
     std::ranges::sort(vertexIndices, compare);
-    utl::stack<IndexType> stack = { vertexIndices[0], vertexIndices[1] };
+    std::pmr::vector<IndexType> stack(scratch);
+    stack.reserve(vertexCount);
+    stack.push_back(vertexIndices[0]);
+    stack.push_back(vertexIndices[1]);
+    auto pop = [&stack] {
+        IndexType top = stack.back();
+        stack.pop_back();
+        return top;
+    };
     size_t indexIndex = 2;
     bool isLeft = (vertexIndices[1] == (vertexIndices[0] + 1) % vertexCount) ==
                   (orientation == Orientation::Counterclockwise);
     for (IndexType index: vertexIndices | std::views::drop(2)) {
-        IndexType prev = stack.pop();
+        IndexType prev = pop();
         bool sameChain = is_distance_one_mod_n(index, prev, vertexCount);
         if (sameChain) {
             while (!stack.empty() &&
                    (index == vertexIndices.back() ||
-                    isLeft != isConvex(stack.top(), prev, index)))
+                    isLeft != isConvex(stack.back(), prev, index)))
             {
-                IndexType top = stack.pop();
-                std::invoke(triangleEmitter, index, top, prev);
+                IndexType top = pop();
+                emitTriangle(index, top, prev);
                 prev = top;
             }
-            stack.push(prev);
-            stack.push(index);
+            stack.push_back(prev);
+            stack.push_back(index);
         }
         else {
             isLeft = !isLeft;
             while (!stack.empty()) {
-                IndexType top = stack.pop();
-                std::invoke(triangleEmitter, index, top, prev);
+                IndexType top = pop();
+                emitTriangle(index, top, prev);
                 prev = top;
             }
-            stack.push(vertexIndices[indexIndex - 1]);
-            stack.push(index);
+            stack.push_back(vertexIndices[indexIndex - 1]);
+            stack.push_back(index);
         }
         ++indexIndex;
     }
 }
 
+template <std::unsigned_integral IndexType = uint32_t, std::input_iterator Itr,
+          std::sentinel_for<Itr> S,
+          std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
+void static triangulatePolyYMonotone(Itr begin, S end,
+                                     TriangleEmitter triangleEmitter,
+                                     Orientation orientation,
+                                     std::pmr::memory_resource* scratch) {
+    auto vertexAt = [begin](IndexType index) { return *(begin + index); };
+    auto vertexCount =
+        static_cast<IndexType>(std::ranges::distance(begin, end));
+    std::pmr::vector<IndexType> polygon(scratch);
+    polygon.reserve(vertexCount);
+    if (appendContour(polygon, std::views::iota(IndexType(0), vertexCount),
+                      vertexAt) < 3)
+    {
+        return;
+    }
+    triangulatePolyYMonotoneImpl<IndexType>(polygon, vertexAt, triangleEmitter,
+                                            orientation, scratch);
+}
+
+namespace {
+
+/// Classification of polygon vertices used by the monotone decomposition
+enum class SweepVertexKind { Start, End, Split, Merge, Regular };
+
+} // namespace
+
+/// Computes the diagonals that partition the polygon \p polygon into Y
+/// monotone pieces with a sweep line from top to bottom. \p next and \p prev
+/// map each position in \p polygon to its neighbours along its contour. The
+/// filled region must lie to the left of each contour in screen coordinates,
+/// i.e., outer contours are oriented clockwise and holes counterclockwise.
+/// Diagonals are returned as pairs of positions in \p polygon. Temporary
+/// buffers and the result are allocated from \p scratch
+///
+/// This is the classic plane sweep algorithm as described in "Computational
+/// Geometry" by de Berg et al., chapter 3. It runs in O(n log n)
+template <std::unsigned_integral IndexType>
+static std::pmr::vector<std::pair<IndexType, IndexType>>
+    computeMonotoneDiagonals(std::span<IndexType const> polygon, auto next,
+                             auto prev, auto vertexAt,
+                             std::pmr::memory_resource* scratch) {
+    using enum SweepVertexKind;
+    IndexType n = static_cast<IndexType>(polygon.size());
+    auto positionAt = [&](IndexType pos) { return vertexAt(polygon[pos]); };
+    // Equal Y coordinates are resolved by the X coordinate, i.e., this sweep
+    // visits vertices in reverse order of the monotone triangulator
+    auto above = [&](IndexType a, IndexType b) {
+        auto p = positionAt(a);
+        auto q = positionAt(b);
+        return p.y == q.y ? p.x > q.x : p.y > q.y;
+    };
+    std::pmr::vector<SweepVertexKind> kinds(n, scratch);
+    for (IndexType v = 0; v < n; ++v) {
+        bool prevAbove = above(prev(v), v);
+        bool nextAbove = above(next(v), v);
+        bool convex = signedArea(positionAt(prev(v)), positionAt(v),
+                                 positionAt(next(v))) > 0;
+        if (!prevAbove && !nextAbove) {
+            kinds[v] = convex ? Start : Split;
+        }
+        else if (prevAbove && nextAbove) {
+            kinds[v] = convex ? End : Merge;
+        }
+        else {
+            kinds[v] = Regular;
+        }
+    }
+    std::pmr::vector<IndexType> order = makeIndexVector<IndexType>(n, scratch);
+    std::ranges::sort(order, above);
+    // The status structure holds the edges `(e, next(e))` that intersect the
+    // sweep line and have the polygon interior to their right, ordered by the
+    // X coordinate of the intersection
+    static constexpr IndexType SweepPoint = ~IndexType(0);
+    double sweepX = 0, sweepY = 0;
+    auto intersectSweepLine = [&](IndexType edge) -> double {
+        if (edge == SweepPoint) {
+            return sweepX;
+        }
+        auto a = positionAt(edge);
+        auto b = positionAt(next(edge));
+        if (a.y == b.y) {
+            return std::clamp(sweepX, double(std::min(a.x, b.x)),
+                              double(std::max(a.x, b.x)));
+        }
+        return a.x + (sweepY - a.y) * double(b.x - a.x) / double(b.y - a.y);
+    };
+    auto edgeCompare = [&](IndexType a, IndexType b) {
+        return intersectSweepLine(a) < intersectSweepLine(b);
+    };
+    std::pmr::set<IndexType, decltype(edgeCompare)> status(edgeCompare,
+                                                           scratch);
+    std::pmr::vector<typename decltype(status)::iterator> statusItrs(n,
+                                                                     scratch);
+    std::pmr::vector<IndexType> helper(n, scratch);
+    std::pmr::vector<std::pair<IndexType, IndexType>> diagonals(scratch);
+    auto insertEdge = [&](IndexType edge) {
+        statusItrs[edge] = status.insert(edge).first;
+        helper[edge] = edge;
+    };
+    auto eraseEdge = [&](IndexType v, IndexType edge) {
+        if (kinds[helper[edge]] == Merge) {
+            diagonals.push_back({ v, helper[edge] });
+        }
+        status.erase(statusItrs[edge]);
+    };
+    auto updateLeftEdge = [&](IndexType v) {
+        auto itr = status.lower_bound(SweepPoint);
+        if (itr == status.begin()) {
+            // Polygon is not simple
+            return;
+        }
+        IndexType edge = *std::prev(itr);
+        if (kinds[helper[edge]] == Merge || kinds[v] == Split) {
+            diagonals.push_back({ v, helper[edge] });
+        }
+        helper[edge] = v;
+    };
+    for (IndexType v: order) {
+        auto position = positionAt(v);
+        sweepX = position.x;
+        sweepY = position.y;
+        switch (kinds[v]) {
+        case Start:
+            insertEdge(v);
+            break;
+        case End:
+            eraseEdge(v, prev(v));
+            break;
+        case Split:
+            updateLeftEdge(v);
+            insertEdge(v);
+            break;
+        case Merge:
+            eraseEdge(v, prev(v));
+            updateLeftEdge(v);
+            break;
+        case Regular:
+            if (above(prev(v), v)) {
+                eraseEdge(v, prev(v));
+                insertEdge(v);
+            }
+            else {
+                updateLeftEdge(v);
+            }
+            break;
+        }
+    }
+    return diagonals;
+}
+
+/// Splits the polygon \p polygon along \p diagonals and invokes \p callback
+/// with the vertex indices of each resulting piece. Pieces have the same
+/// orientation as the contours of \p polygon
+template <std::unsigned_integral IndexType>
+static void splitPolygon(
+    std::span<IndexType const> polygon, auto next,
+    std::span<std::pair<IndexType, IndexType> const> diagonals, auto vertexAt,
+    std::pmr::memory_resource* scratch,
+    std::invocable<std::span<IndexType const>> auto callback) {
+    IndexType n = static_cast<IndexType>(polygon.size());
+    struct HalfEdge {
+        IndexType origin, target;
+        double angle;
+        bool interior;
+    };
+    std::pmr::vector<HalfEdge> edges(scratch);
+    edges.reserve(2 * (n + diagonals.size()));
+    auto addEdge = [&](IndexType origin, IndexType target, bool interior) {
+        auto d = vertexAt(polygon[target]) - vertexAt(polygon[origin]);
+        edges.push_back({ origin, target, std::atan2(double(d.y), double(d.x)),
+                          interior });
+    };
+    for (IndexType v = 0; v < n; ++v) {
+        addEdge(v, next(v), true);
+        addEdge(next(v), v, false);
+    }
+    for (auto [a, b]: diagonals) {
+        addEdge(a, b, true);
+        addEdge(b, a, true);
+    }
+    // Sort the half edges counterclockwise around their origin vertices
+    std::ranges::sort(edges, [](HalfEdge const& a, HalfEdge const& b) {
+        return a.origin == b.origin ? a.angle < b.angle : a.origin < b.origin;
+    });
+    std::pmr::vector<size_t> firstEdge(n + 1, scratch);
+    for (auto& edge: edges) {
+        ++firstEdge[edge.origin + 1];
+    }
+    std::partial_sum(firstEdge.begin(), firstEdge.end(), firstEdge.begin());
+    // Returns the half edge that follows index along the boundary of the
+    // face to its left
+    auto nextEdge = [&](size_t index) {
+        auto& edge = edges[index];
+        size_t first = firstEdge[edge.target];
+        size_t last = firstEdge[edge.target + 1];
+        size_t twin = first;
+        while (edges[twin].target != edge.origin) {
+            ++twin;
+            assert(twin < last);
+        }
+        return twin == first ? last - 1 : twin - 1;
+    };
+    std::pmr::vector<bool> visited(edges.size(), false, scratch);
+    std::pmr::vector<IndexType> piece(scratch);
+    for (size_t start = 0; start < edges.size(); ++start) {
+        if (visited[start] || !edges[start].interior) {
+            continue;
+        }
+        piece.clear();
+        for (size_t index = start; !visited[index]; index = nextEdge(index)) {
+            visited[index] = true;
+            piece.push_back(polygon[edges[index].origin]);
+        }
+        std::invoke(callback, std::span<IndexType const>(piece));
+    }
+}
+
+/// Triangulates arbitrary simple polygons in O(n log n) by partitioning them
+/// into Y monotone pieces which are then triangulated in linear time
+template <std::unsigned_integral IndexType = uint32_t,
+          std::random_access_iterator Itr, std::sentinel_for<Itr> S,
+          std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
+void static triangulatePolyMonotoneDecomposition(
+    Itr begin, S end, TriangleEmitter triangleEmitter,
+    std::pmr::memory_resource* scratch) {
+    auto vertexAt = [begin](IndexType index) { return *(begin + index); };
+    auto vertexCount =
+        static_cast<IndexType>(std::ranges::distance(begin, end));
+    std::pmr::vector<IndexType> polygon(scratch);
+    polygon.reserve(vertexCount);
+    if (appendContour(polygon, std::views::iota(IndexType(0), vertexCount),
+                      vertexAt) < 3)
+    {
+        return;
+    }
+    if (polygonSignedArea(polygon, vertexAt) < 0) {
+        std::ranges::reverse(polygon);
+    }
+    IndexType n = static_cast<IndexType>(polygon.size());
+    auto next = [n](IndexType pos) -> IndexType { return (pos + 1) % n; };
+    auto prev = [n](IndexType pos) -> IndexType { return (pos + n - 1) % n; };
+    auto diagonals = computeMonotoneDiagonals<IndexType>(polygon, next, prev,
+                                                         vertexAt, scratch);
+    if (diagonals.empty()) {
+        triangulatePolyYMonotoneImpl<IndexType>(polygon, vertexAt,
+                                                triangleEmitter,
+                                                Orientation::Clockwise,
+                                                scratch);
+        return;
+    }
+    splitPolygon<IndexType>(polygon, next, diagonals, vertexAt, scratch,
+                            [&](std::span<IndexType const> piece) {
+        triangulatePolyYMonotoneImpl<IndexType>(piece, vertexAt,
+                                                triangleEmitter,
+                                                Orientation::Clockwise,
+                                                scratch);
+    });
+}
+
+/// Winding number of the closed contour \p contour around \p point. The
+/// winding number is positive for contours oriented clockwise in screen
+/// coordinates
+template <typename VecType>
+static int windingNumber(std::span<VecType const> contour, VecType point) {
+    int result = 0;
+    for (size_t i = 0, n = contour.size(); i < n; ++i) {
+        auto a = contour[i];
+        auto b = contour[(i + 1) % n];
+        if (a.y <= point.y) {
+            if (b.y > point.y && signedArea(a, b, point) > 0) {
+                ++result;
+            }
+        }
+        else if (b.y <= point.y && signedArea(a, b, point) < 0) {
+            --result;
+        }
+    }
+    return result;
+}
+
+static bool isFilled(int windingNumber, FillRule fillRule) {
+    switch (fillRule) {
+    case FillRule::EvenOdd:
+        return windingNumber % 2 != 0;
+    case FillRule::NonZero:
+        return windingNumber != 0;
+    }
+    return false;
+}
+
+/// Triangulates the region bounded by the contours \p contours according to
+/// \p fillRule. Contours must be simple and must not intersect each other, but
+/// they may be nested to an arbitrary depth
+///
+/// We determine for each contour whether it separates a filled from an
+/// unfilled region and orient it such that the filled region lies to its left.
+/// Contours that do not bound the filled region are dropped. The resulting
+/// polygon with holes is then decomposed into monotone pieces by the same
+/// sweep as simple polygons
+template <std::unsigned_integral IndexType = uint32_t,
+          std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
+static void triangulateContours(
+    std::span<std::span<vml::float2 const> const> contours,
+    TriangleEmitter triangleEmitter, FillRule fillRule,
+    std::pmr::memory_resource* scratch) {
+    std::pmr::vector<vml::float2> vertices(scratch);
+    for (auto contour: contours) {
+        vertices.insert(vertices.end(), contour.begin(), contour.end());
+    }
+    auto vertexAt = [&](IndexType index) { return vertices[index]; };
+    std::pmr::vector<IndexType> polygon(scratch);
+    polygon.reserve(vertices.size());
+    std::pmr::vector<IndexType> next(vertices.size(), scratch),
+        prev(vertices.size(), scratch);
+    IndexType offset = 0;
+    for (size_t i = 0; i < contours.size(); ++i) {
+        auto contour = contours[i];
+        IndexType first = offset;
+        offset += static_cast<IndexType>(contour.size());
+        if (contour.size() < 3) {
+            continue;
+        }
+        auto indices = std::views::iota(first, offset);
+        double area = polygonSignedArea(indices, vertexAt);
+        if (area == 0) {
+            continue;
+        }
+        int windingOutside = 0;
+        for (size_t j = 0; j < contours.size(); ++j) {
+            if (j != i) {
+                windingOutside += windingNumber(contours[j], contour.front());
+            }
+        }
+        int windingInside = windingOutside + (area > 0 ? 1 : -1);
+        bool filledInside = isFilled(windingInside, fillRule);
+        if (filledInside == isFilled(windingOutside, fillRule)) {
+            continue;
+        }
+        IndexType begin = static_cast<IndexType>(polygon.size());
+        size_t count = (area > 0) == filledInside ?
+                           appendContour(polygon, indices, vertexAt) :
+                           appendContour(polygon,
+                                         indices | std::views::reverse,
+                                         vertexAt);
+        if (count < 3) {
+            polygon.resize(begin);
+            continue;
+        }
+        IndexType end = static_cast<IndexType>(polygon.size());
+        for (IndexType pos = begin; pos < end; ++pos) {
+            next[pos] = pos + 1 == end ? begin : pos + 1;
+            prev[pos] = pos == begin ? end - 1 : pos - 1;
+        }
+    }
+    if (polygon.empty()) {
+        return;
+    }
+    auto nextFn = [&](IndexType pos) { return next[pos]; };
+    auto prevFn = [&](IndexType pos) { return prev[pos]; };
+    auto diagonals = computeMonotoneDiagonals<IndexType>(polygon, nextFn,
+                                                         prevFn, vertexAt,
+                                                         scratch);
+    splitPolygon<IndexType>(polygon, nextFn, diagonals, vertexAt, scratch,
+                            [&](std::span<IndexType const> piece) {
+        triangulatePolyYMonotoneImpl<IndexType>(piece, vertexAt,
+                                                triangleEmitter,
+                                                Orientation::Clockwise,
+                                                scratch);
+    });
+}
+
 void xui::triangulatePolygon(
     std::span<vml::float2 const> vertices,
     utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
     TriangulationOptions options) {
+    auto* scratch = scratchResource(options.scratch);
     if (options.isYMonotone) {
         triangulatePolyYMonotone(vertices.begin(), vertices.end(),
-                                 triangleEmitter, options.orientation);
+                                 triangleEmitter, options.orientation, scratch);
         return;
     }
-    triangulatePolyEarClipping(vertices.begin(), vertices.end(),
-                               triangleEmitter);
+    triangulatePolyMonotoneDecomposition(vertices.begin(), vertices.end(),
+                                         triangleEmitter, scratch);
+}
+
+void xui::triangulatePolygon(
+    std::span<std::span<vml::float2 const> const> contours,
+    utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
+    TriangulationOptions options) {
+    triangulateContours(contours, triangleEmitter, options.fillRule,
+                        scratchResource(options.scratch));
+}
+
+size_t xui::polygonIndexCount(size_t numVertices, size_t numContours) {
+    // Triangulating a polygon with h holes yields n + 2h - 2 triangles.
+    // Contours that don't bound the filled region only produce fewer
+    size_t numTriangles = numVertices + 2 * numContours;
+    return numTriangles < 4 ? 0 : 3 * (numTriangles - 4);
+}
+
+size_t xui::triangulatePolygonInto(std::span<vml::float2 const> vertices,
+                                   std::span<uint32_t> indices,
+                                   TriangulationOptions options) {
+    IndexWriter indexWriter{ indices.data(), indices.size() };
+    auto emitter = [&](uint32_t a, uint32_t b, uint32_t c) {
+        indexWriter(a, b, c);
+    };
+    auto* scratch = scratchResource(options.scratch);
+    if (options.isYMonotone) {
+        triangulatePolyYMonotone(vertices.begin(), vertices.end(), emitter,
+                                 options.orientation, scratch);
+    }
+    else {
+        triangulatePolyMonotoneDecomposition(vertices.begin(), vertices.end(),
+                                             emitter, scratch);
+    }
+    return indexWriter.size;
+}
+
+size_t xui::triangulatePolygonInto(
+    std::span<std::span<vml::float2 const> const> contours,
+    std::span<uint32_t> indices, TriangulationOptions options) {
+    IndexWriter indexWriter{ indices.data(), indices.size() };
+    triangulateContours(
+        contours,
+        [&](uint32_t a, uint32_t b, uint32_t c) { indexWriter(a, b, c); },
+        options.fillRule, scratchResource(options.scratch));
+    return indexWriter.size;
+}
+
+/// Maximum factor by which fringe vertices at sharp corners are pushed further
+/// out to keep the fringe width constant along both edges
+static constexpr float MaxFringeMiter = 4;
+
+template <std::unsigned_integral IndexType = uint32_t,
+          std::invocable<vml::float2> VertexEmitter,
+          std::invocable<IndexType, IndexType, IndexType> TriangleEmitter>
+static void buildAntialiasingFringeImpl(std::span<vml::float2 const> vertices,
+                                        std::span<IndexType const> indices,
+                                        VertexEmitter vertexEmitter,
+                                        TriangleEmitter triangleEmitter,
+                                        float width,
+                                        std::pmr::memory_resource* scratch) {
+    using vml::float2;
+    // Edges that belong to exactly one triangle are boundary edges. We store
+    // the vertex opposite to the edge to determine the outward direction
+    struct EdgeInfo {
+        IndexType a, b, opposite;
+        int count;
+    };
+    std::pmr::unordered_map<uint64_t, EdgeInfo> edges(scratch);
+    edges.reserve(indices.size());
+    auto addEdge = [&](IndexType a, IndexType b, IndexType opposite) {
+        uint64_t key = (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+        auto [itr, inserted] = edges.insert({ key, { a, b, opposite, 0 } });
+        ++itr->second.count;
+    };
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        IndexType a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        addEdge(a, b, c);
+        addEdge(b, c, a);
+        addEdge(c, a, b);
+    }
+    struct BoundaryEdge {
+        IndexType a, b;
+        float2 normal;
+    };
+    std::pmr::vector<BoundaryEdge> boundary(scratch);
+    for (auto& [key, edge]: edges) {
+        if (edge.count != 1) {
+            continue;
+        }
+        float2 d = vertices[edge.b] - vertices[edge.a];
+        float length = std::sqrt(dot(d, d));
+        if (!(length > 0)) {
+            continue;
+        }
+        float2 normal = float2(d.y, -d.x) / length;
+        if (dot(normal, vertices[edge.opposite] - vertices[edge.a]) > 0) {
+            normal = -normal;
+        }
+        boundary.push_back({ edge.a, edge.b, normal });
+    }
+    // Every boundary vertex gets one fringe vertex, offset along the sum of
+    // the normals of its boundary edges
+    struct FringeVertex {
+        float2 normalSum{ 0, 0 };
+        float2 firstNormal{ 0, 0 };
+        int numEdges = 0;
+        IndexType index = 0;
+    };
+    std::pmr::vector<FringeVertex> fringe(vertices.size(), scratch);
+    for (auto& edge: boundary) {
+        for (IndexType v: { edge.a, edge.b }) {
+            auto& f = fringe[v];
+            if (f.numEdges++ == 0) {
+                f.firstNormal = edge.normal;
+            }
+            f.normalSum += edge.normal;
+        }
+    }
+    IndexType numVertices = IndexType(vertices.size());
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        auto& f = fringe[v];
+        if (f.numEdges == 0) {
+            continue;
+        }
+        float sumLength = std::sqrt(dot(f.normalSum, f.normalSum));
+        float2 offset = f.firstNormal;
+        if (sumLength > 1e-4f) {
+            float2 dir = f.normalSum / sumLength;
+            float scale = 1;
+            if (f.numEdges == 2) {
+                // Like a miter join, so the fringe has the same width along
+                // both edges
+                scale = std::min(1 / std::max(dot(dir, f.firstNormal), 1e-4f),
+                                 MaxFringeMiter);
+            }
+            offset = scale * dir;
+        }
+        f.index = numVertices++;
+        std::invoke(vertexEmitter, vertices[v] + width * offset);
+    }
+    for (auto& edge: boundary) {
+        IndexType fa = fringe[edge.a].index, fb = fringe[edge.b].index;
+        std::invoke(triangleEmitter, edge.a, edge.b, fb);
+        std::invoke(triangleEmitter, edge.a, fb, fa);
+    }
+}
+
+void xui::buildAntialiasingFringe(
+    std::span<vml::float2 const> vertices, std::span<uint32_t const> indices,
+    utl::function_view<void(vml::float2)> vertexEmitter,
+    utl::function_view<void(uint32_t, uint32_t, uint32_t)> triangleEmitter,
+    float width, std::pmr::memory_resource* scratch) {
+    buildAntialiasingFringeImpl(vertices, indices, vertexEmitter,
+                                triangleEmitter, width,
+                                scratchResource(scratch));
+}
+
+MeshSize xui::weldVertices(std::span<vml::float2> vertices,
+                           std::span<uint32_t> indices,
+                           std::pmr::memory_resource* scratch) {
+    scratch = scratchResource(scratch);
+    // Adding zero maps -0 to +0 so equal positions get equal keys
+    auto key = [](vml::float2 p) {
+        return (uint64_t)std::bit_cast<uint32_t>(p.x + 0.0f) << 32 |
+               std::bit_cast<uint32_t>(p.y + 0.0f);
+    };
+    std::pmr::unordered_map<uint64_t, uint32_t> positions(scratch);
+    positions.reserve(vertices.size());
+    std::pmr::vector<uint32_t> remap(vertices.size(), scratch);
+    uint32_t numVertices = 0;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto [itr, inserted] = positions.insert({ key(vertices[i]),
+                                                  numVertices });
+        if (inserted) {
+            vertices[numVertices++] = vertices[i];
+        }
+        remap[i] = itr->second;
+    }
+    size_t numIndices = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t a = remap[indices[i]], b = remap[indices[i + 1]],
+                 c = remap[indices[i + 2]];
+        if (a == b || b == c || c == a) {
+            continue;
+        }
+        indices[numIndices++] = a;
+        indices[numIndices++] = b;
+        indices[numIndices++] = c;
+    }
+    return { numVertices, numIndices };
 }
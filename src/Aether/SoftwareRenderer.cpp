@@ -0,0 +1,437 @@
+#include "Aether/SoftwareRenderer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+#include <csp.hpp>
+
+#include "Aether/ThreadPool.h"
+#include "Aether/View.h"
+
+using namespace xui;
+using namespace vml::short_types;
+
+namespace {
+
+/// Fill of a paint in the coordinates of the vertices. Flat colors are
+/// gradients with equal colors and zero direction, so both are evaluated by
+/// the same branch free code
+struct Fill {
+    std::array<float, 4> begin, end;
+    float2 origin;
+    float2 direction;
+    float invLengthSquared;
+};
+
+/// Triangle in pixel coordinates. Edge `i` is opposite of vertex `i`
+struct Triangle {
+    /// Coefficients of the edge function `A * (x - ox) + B * (y - oy)`, which
+    /// is positive inside the triangle. For wireframe triangles the function
+    /// is normalized to the distance to the edge
+    std::array<float, 3> A, B, ox, oy;
+
+    /// Edges that own the pixels exactly on them
+    std::array<bool, 3> owns;
+
+    /// Coverage at vertex 0 and its change per unit of edge function 1 and 2
+    float coverage, slope1, slope2;
+
+    /// Pixel bounds, `max` is exclusive
+    int minX, minY, maxX, maxY;
+
+    /// Gradient parameter as a linear function of the pixel position
+    float gradientX, gradientY, gradientOffset;
+
+    /// Multiplied with the colors of the fill
+    std::array<float, 4> tint;
+
+    uint32_t fillIndex;
+    bool wireframe;
+};
+
+/// Color channels of a tile, stored as separate planes so rows are blended
+/// with vector instructions
+struct TileBuffer {
+    static constexpr size_t Size = SoftwareRenderer::TileSize;
+
+    std::array<float, Size * Size> r, g, b, a;
+};
+
+/// Rectangle of pixels, `max` is exclusive
+struct PixelRect {
+    int minX, minY, maxX, maxY;
+};
+
+/// The image a tile is rasterized into
+struct Target {
+    std::span<uint8_t> pixels;
+    size_t width, height;
+    size_t numTilesX;
+};
+
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer(size_t width, size_t height,
+                                   RendererOptions const& options,
+                                   size_t numThreads):
+    options(options), numThreads(numThreads) {
+    if (this->numThreads == 0) {
+        this->numThreads = ThreadPool::shared().numThreads();
+    }
+    resize(width, height);
+}
+
+SoftwareRenderer::SoftwareRenderer(View* view, RendererOptions const& options,
+                                   size_t numThreads):
+    SoftwareRenderer(0, 0, options, numThreads) {
+    this->view = view;
+}
+
+void SoftwareRenderer::resize(size_t width, size_t height) {
+    _width = width;
+    _height = height;
+    numTilesX = (width + TileSize - 1) / TileSize;
+    numTilesY = (height + TileSize - 1) / TileSize;
+    _pixels.assign(width * height * 4, 0);
+    bins.resize(numTilesX * numTilesY);
+}
+
+uint32_t SoftwareRenderer::pixel(size_t x, size_t y) const {
+    assert(x < _width && y < _height);
+    auto* p = &_pixels[(y * _width + x) * 4];
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+           (uint32_t)p[3] << 24;
+}
+
+static std::array<float, 4> toFloat4(Color const& color) {
+    return { (float)color.red(), (float)color.green(), (float)color.blue(),
+             (float)color.alpha() };
+}
+
+static Fill makeFill(FillMode const& paint) {
+    // clang-format off
+    return std::visit(csp::overload{
+        [](FlatColor const& c) -> Fill {
+            auto color = toFloat4(c.color);
+            return { color, color, { 0, 0 }, { 0, 0 }, 0 };
+        },
+        [](Gradient const& g) -> Fill {
+            float2 origin = g.begin.coord;
+            float2 direction = g.end.coord - origin;
+            float lengthSquared = dot(direction, direction);
+            return { toFloat4(g.begin.color), toFloat4(g.end.color), origin,
+                     direction,
+                     lengthSquared > 0 ? 1 / lengthSquared : 0 };
+        },
+    }, paint); // clang-format on
+}
+
+/// \Returns the pixels whose centers lie in \p clip, clamped to the image
+static PixelRect clipPixels(ClipRect const& clip, float scale, int width,
+                            int height) {
+    auto bound = [&](float value, int limit) {
+        return (int)std::clamp(std::ceil(value * scale - 0.5f), 0.0f,
+                               (float)limit);
+    };
+    return { bound(clip.min.x, width), bound(clip.min.y, height),
+             bound(clip.max.x, width), bound(clip.max.y, height) };
+}
+
+/// Sets up the edge functions and bounds of the triangle \p p with per vertex
+/// coverage \p cov. \Returns false if the triangle is degenerate or does not
+/// overlap \p clip
+static bool setupTriangle(Triangle& tri, std::array<float2, 3> p,
+                          std::array<float, 3> cov, PixelRect clip) {
+    auto cross = [](float2 a, float2 b) { return a.x * b.y - a.y * b.x; };
+    float area = cross(p[1] - p[0], p[2] - p[0]);
+    if (!std::isfinite(area) || area == 0) {
+        return false;
+    }
+    if (area < 0) {
+        std::swap(p[1], p[2]);
+        std::swap(cov[1], cov[2]);
+        area = -area;
+    }
+    for (int i = 0; i < 3; ++i) {
+        float2 a = p[(i + 1) % 3];
+        float2 b = p[(i + 2) % 3];
+        tri.A[i] = a.y - b.y;
+        tri.B[i] = b.x - a.x;
+        // Both triangles that share an edge evaluate it relative to the same
+        // endpoint and get exactly negated values, so every pixel on the edge
+        // is drawn by exactly one of them
+        bool aFirst = a.x < b.x || (a.x == b.x && a.y < b.y);
+        tri.ox[i] = aFirst ? a.x : b.x;
+        tri.oy[i] = aFirst ? a.y : b.y;
+        tri.owns[i] = tri.A[i] > 0 || (tri.A[i] == 0 && tri.B[i] > 0);
+    }
+    // Interpolating relative to vertex 0 reproduces equal coverages exactly
+    tri.coverage = cov[0];
+    tri.slope1 = (cov[1] - cov[0]) / area;
+    tri.slope2 = (cov[2] - cov[0]) / area;
+    if (tri.wireframe) {
+        std::array<float, 3> length;
+        for (int i = 0; i < 3; ++i) {
+            length[i] = std::hypot(tri.A[i], tri.B[i]);
+            tri.A[i] /= length[i];
+            tri.B[i] /= length[i];
+        }
+        tri.slope1 *= length[1];
+        tri.slope2 *= length[2];
+    }
+    float pad = tri.wireframe ? 1.0f : 0.0f;
+    auto bound = [&](float value, int min, int max) {
+        return (int)std::clamp(value, (float)min, (float)max);
+    };
+    tri.minX = bound(std::floor(std::min({ p[0].x, p[1].x, p[2].x }) - pad),
+                     clip.minX, clip.maxX);
+    tri.minY = bound(std::floor(std::min({ p[0].y, p[1].y, p[2].y }) - pad),
+                     clip.minY, clip.maxY);
+    tri.maxX = bound(std::ceil(std::max({ p[0].x, p[1].x, p[2].x }) + pad),
+                     clip.minX, clip.maxX);
+    tri.maxY = bound(std::ceil(std::max({ p[0].y, p[1].y, p[2].y }) + pad),
+                     clip.minY, clip.maxY);
+    return tri.minX < tri.maxX && tri.minY < tri.maxY;
+}
+
+/// \Returns a conservative range of pixel columns of a row of a tile at
+/// \p tileX that may be covered by \p tri. \p rowTerms are the parts of the
+/// edge functions that only depend on the row
+static std::pair<int, int> rowSpan(Triangle const& tri,
+                                   std::array<float, 3> rowTerms,
+                                   float lowerBound, float tileX) {
+    float begin = -INFINITY, end = INFINITY;
+    for (int i = 0; i < 3; ++i) {
+        float A = tri.A[i];
+        if (A == 0) {
+            if (rowTerms[i] < lowerBound) {
+                return { 0, 0 };
+            }
+            continue;
+        }
+        // Pixel center at which the edge function equals `lowerBound`
+        float x = tri.ox[i] + (lowerBound - rowTerms[i]) / A;
+        if (A > 0) {
+            begin = std::max(begin, x);
+        }
+        else {
+            end = std::min(end, x);
+        }
+    }
+    // One pixel of slack on either side absorbs rounding, the exact test is
+    // done per pixel
+    float limit = (float)SoftwareRenderer::TileSize;
+    begin = std::clamp(std::floor(begin - tileX - 0.5f) - 1, 0.0f, limit);
+    end = std::clamp(std::ceil(end - tileX - 0.5f) + 2, 0.0f, limit);
+    return { (int)begin, (int)end };
+}
+
+/// Blends the triangles \p tileTriangles in order into the tile \p tileIndex of
+/// \p target
+static void rasterizeTile(Target target, size_t tileIndex,
+                          std::span<Triangle const> triangles,
+                          std::span<Fill const> fills,
+                          std::span<uint32_t const> tileTriangles) {
+    static constexpr int Size = (int)SoftwareRenderer::TileSize;
+    int tileX = (int)(tileIndex % target.numTilesX) * Size;
+    int tileY = (int)(tileIndex / target.numTilesX) * Size;
+    int tileWidth = std::min(Size, (int)target.width - tileX);
+    int tileHeight = std::min(Size, (int)target.height - tileY);
+    TileBuffer tile;
+    tile.r.fill(0);
+    tile.g.fill(0);
+    tile.b.fill(0);
+    tile.a.fill(0);
+    for (uint32_t triIndex: tileTriangles) {
+        auto& tri = triangles[triIndex];
+        auto& fill = fills[tri.fillIndex];
+        int beginX = std::max(tri.minX, tileX) - tileX;
+        int endX = std::min(tri.maxX, tileX + tileWidth) - tileX;
+        int beginY = std::max(tri.minY, tileY) - tileY;
+        int endY = std::min(tri.maxY, tileY + tileHeight) - tileY;
+        // Solid triangles cover pixels with non-negative edge functions,
+        // wireframe triangles cover pixels within half a pixel of an edge
+        float lowerBound = tri.wireframe ? -0.5f : 0.0f;
+        float upperBound = tri.wireframe ? 0.5f : INFINITY;
+        auto [A0, A1, A2] = tri.A;
+        auto [ox0, ox1, ox2] = tri.ox;
+        auto [own0, own1, own2] = tri.owns;
+        float coverage0 = tri.coverage, slope1 = tri.slope1,
+              slope2 = tri.slope2;
+        auto [tr, tg, tb, ta] = tri.tint;
+        float r0 = fill.begin[0] * tr, g0 = fill.begin[1] * tg,
+              b0 = fill.begin[2] * tb, a0 = fill.begin[3] * ta;
+        float dr = fill.end[0] * tr - r0, dg = fill.end[1] * tg - g0,
+              db = fill.end[2] * tb - b0, da = fill.end[3] * ta - a0;
+        float gradientX = tri.gradientX;
+        for (int y = beginY; y < endY; ++y) {
+            float py = (float)(tileY + y) + 0.5f;
+            float R0 = tri.B[0] * (py - tri.oy[0]);
+            float R1 = tri.B[1] * (py - tri.oy[1]);
+            float R2 = tri.B[2] * (py - tri.oy[2]);
+            auto [rowBegin, rowEnd] =
+                rowSpan(tri, { R0, R1, R2 }, lowerBound, (float)tileX);
+            int x0 = std::max(beginX, rowBegin);
+            int x1 = std::min(endX, rowEnd);
+            float gradientRow = py * tri.gradientY + tri.gradientOffset;
+            float* r = tile.r.data() + y * Size;
+            float* g = tile.g.data() + y * Size;
+            float* b = tile.b.data() + y * Size;
+            float* a = tile.a.data() + y * Size;
+            // The loop body is branch free so it can be vectorized
+            for (int x = x0; x < x1; ++x) {
+                float px = (float)(tileX + x) + 0.5f;
+                float e0 = A0 * (px - ox0) + R0;
+                float e1 = A1 * (px - ox1) + R1;
+                float e2 = A2 * (px - ox2) + R2;
+                bool inside =
+                    ((e0 > lowerBound) | ((e0 == lowerBound) & own0)) &
+                    ((e1 > lowerBound) | ((e1 == lowerBound) & own1)) &
+                    ((e2 > lowerBound) | ((e2 == lowerBound) & own2)) &
+                    (std::min(e0, std::min(e1, e2)) <= upperBound);
+                float coverage = std::min(
+                    std::max(coverage0 + e1 * slope1 + e2 * slope2, 0.0f),
+                    1.0f);
+                float t = std::min(
+                    std::max(px * gradientX + gradientRow, 0.0f), 1.0f);
+                float alpha = (a0 + da * t) * coverage * (inside ? 1.0f : 0.0f);
+                float keep = 1 - alpha;
+                r[x] = (r0 + dr * t) * alpha + r[x] * keep;
+                g[x] = (g0 + dg * t) * alpha + g[x] * keep;
+                b[x] = (b0 + db * t) * alpha + b[x] * keep;
+                a[x] = alpha + a[x] * keep;
+            }
+        }
+    }
+    auto toUnorm = [](float value) {
+        return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255);
+    };
+    for (int y = 0; y < tileHeight; ++y) {
+        uint8_t* out =
+            &target.pixels[((size_t)(tileY + y) * target.width +
+                            (size_t)tileX) *
+                           4];
+        size_t row = (size_t)(y * Size);
+        for (int x = 0; x < tileWidth; ++x) {
+            size_t index = row + (size_t)x;
+            out[4 * x + 0] = toUnorm(tile.r[index]);
+            out[4 * x + 1] = toUnorm(tile.g[index]);
+            out[4 * x + 2] = toUnorm(tile.b[index]);
+            out[4 * x + 3] = toUnorm(tile.a[index]);
+        }
+    }
+}
+
+/// \Returns the index \p i of \p drawCall, which is relative to its first
+/// vertex
+static uint32_t indexAt(DrawData const& data, DrawCall const& drawCall,
+                        size_t i) {
+    return drawCall.indexType == IndexType::UInt16 ? data.shortIndices[i] :
+                                                     data.indices[i];
+}
+
+void SoftwareRenderer::render(DrawData const& data) {
+    if (view) {
+        auto size = view->size();
+        size_t width = (size_t)std::max(0.0, size.width() * _scale);
+        size_t height = (size_t)std::max(0.0, size.height() * _scale);
+        if (width != _width || height != _height) {
+            resize(width, height);
+        }
+    }
+    for (auto& bin: bins) {
+        bin.clear();
+    }
+    std::vector<Fill> fills;
+    fills.reserve(data.paints.size());
+    for (auto& paint: data.paints) {
+        fills.push_back(makeFill(paint));
+    }
+    std::vector<Triangle> triangles;
+    triangles.reserve((data.indices.size() + data.shortIndices.size()) / 3);
+    // Sets up and bins the triangles of a draw call
+    auto addTriangles = [&](DrawCall const& drawCall, PixelRect clip,
+                            Transform2D const& toPixels,
+                            std::array<float, 4> tint) {
+        // Maps pixel positions back to the coordinates of the gradients.
+        // Singular transforms only produce degenerate triangles, which never
+        // evaluate the gradient
+        Transform2D toLocal = {};
+        if (toPixels.determinant() != 0) {
+            toLocal = toPixels.inverse();
+        }
+        for (size_t i = drawCall.beginIndex; i + 3 <= drawCall.endIndex;
+             i += 3) {
+            Triangle tri;
+            tri.wireframe = drawCall.options.wireframe;
+            tri.tint = tint;
+            std::array<float2, 3> p;
+            std::array<float, 3> cov;
+            for (size_t k = 0; k < 3; ++k) {
+                // Indices are relative to the first vertex of the draw call
+                size_t index =
+                    drawCall.beginVertex + indexAt(data, drawCall, i + k);
+                assert(index < drawCall.endVertex);
+                p[k] = toPixels(data.vertices[index]);
+                cov[k] = data.coverage[index];
+            }
+            tri.fillIndex =
+                data.paintIndices[drawCall.beginVertex +
+                                  indexAt(data, drawCall, i)];
+            assert(tri.fillIndex < fills.size());
+            if (!setupTriangle(tri, p, cov, clip)) {
+                continue;
+            }
+            auto& fill = fills[tri.fillIndex];
+            float2 gradient = fill.direction * fill.invLengthSquared;
+            tri.gradientX = dot(toLocal.column0, gradient);
+            tri.gradientY = dot(toLocal.column1, gradient);
+            tri.gradientOffset =
+                dot(toLocal.translation - fill.origin, gradient);
+            uint32_t triIndex = (uint32_t)triangles.size();
+            triangles.push_back(tri);
+            for (size_t ty = (size_t)tri.minY / TileSize;
+                 ty <= (size_t)(tri.maxY - 1) / TileSize; ++ty) {
+                for (size_t tx = (size_t)tri.minX / TileSize;
+                     tx <= (size_t)(tri.maxX - 1) / TileSize; ++tx) {
+                    bins[ty * numTilesX + tx].push_back(triIndex);
+                }
+            }
+        }
+    };
+    for (auto& drawCall: data.drawCalls) {
+        auto clip =
+            clipPixels(drawCall.clipRect, _scale, (int)_width, (int)_height);
+        if (clip.minX >= clip.maxX || clip.minY >= clip.maxY) {
+            continue;
+        }
+        auto toPixels = Transform2D::Scale(_scale) * drawCall.transform;
+        if (!drawCall.instanced()) {
+            addTriangles(drawCall, clip, toPixels, { 1, 1, 1, 1 });
+            continue;
+        }
+        // Instances are expanded into separate triangles
+        for (auto& instance: data.instances.subspan(
+                 drawCall.beginInstance,
+                 drawCall.endInstance - drawCall.beginInstance))
+        {
+            auto instanceTransform = Transform2D::Translation(instance.offset) *
+                                     Transform2D::Scale(instance.scale);
+            auto [r, g, b, a] = instance.color.data;
+            addTriangles(drawCall, clip, toPixels * instanceTransform,
+                         { r, g, b, a });
+        }
+    }
+    Target target = { _pixels, _width, _height, numTilesX };
+    size_t numTiles = numTilesX * numTilesY;
+    std::atomic<size_t> nextTile = 0;
+    auto worker = [&] {
+        for (size_t i; (i = nextTile++) < numTiles;) {
+            rasterizeTile(target, i, triangles, fills, bins[i]);
+        }
+    };
+    ThreadPool::shared().run(std::min(numThreads, numTiles), worker);
+}
@@ -0,0 +1,88 @@
+#include "Aether/ThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace xui;
+
+/// True while a thread runs a job of any pool. Nested calls to `run()` would
+/// wait for themselves, so they invoke the job inline
+static thread_local bool isRunningJob = false;
+
+/// Runs \p fn with `isRunningJob` set
+static void runJob(utl::function_view<void()> fn) {
+    bool wasRunningJob = std::exchange(isRunningJob, true);
+    fn();
+    isRunningJob = wasRunningJob;
+}
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(numThreads - 1);
+    for (size_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back([this, i] { workerMain(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(size_t numInvocations, utl::function_view<void()> fn) {
+    numInvocations = std::min(numInvocations, numThreads());
+    if (numInvocations <= 1 || isRunningJob) {
+        runJob(fn);
+        return;
+    }
+    std::lock_guard runLock(runMutex);
+    {
+        std::lock_guard lock(mutex);
+        job = &fn;
+        numJobWorkers = numInvocations;
+        numPending = numInvocations - 1;
+        ++generation;
+    }
+    wakeCondition.notify_all();
+    runJob(fn);
+    std::unique_lock lock(mutex);
+    doneCondition.wait(lock, [&] { return numPending == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerMain(size_t index) {
+    size_t seenGeneration = 0;
+    std::unique_lock lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [&] {
+            return stopping || generation != seenGeneration;
+        });
+        if (stopping) {
+            return;
+        }
+        seenGeneration = generation;
+        if (index >= numJobWorkers) {
+            continue;
+        }
+        auto* fn = job;
+        lock.unlock();
+        runJob(*fn);
+        lock.lock();
+        if (--numPending == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
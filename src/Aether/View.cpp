@@ -1,8 +1,10 @@
 #include "Aether/View.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
-
-#include <range/v3/view.hpp>
+#include <cmath>
+#include <limits>
 
 #include "Aether/DrawingContext.h"
 #include "Aether/ViewUtil.h"
@@ -21,26 +23,104 @@ View::View(ViewOptions const& options):
 }
 
 void View::layout(Rect frame) {
-    if (auto padding = getAttribute<ViewAttributeKey::PaddingX>()) {
-        frame.origin().x += *padding;
-        frame.width() -= 2 * *padding;
-    }
-    if (auto padding = getAttribute<ViewAttributeKey::PaddingY>()) {
-        frame.origin().y += *padding;
-        frame.height() -= 2 * *padding;
+    if (!_needsLayout && frame == _layoutFrame) {
+        return;
     }
+    // Cleared before `doLayout()` so subviews that invalidate their ancestors
+    // while being laid out are laid out again next time
+    _needsLayout = false;
+    _layoutFrame = frame;
+    Size padding = this->padding();
+    frame.origin() += padding / 2.0;
+    frame.size() -= padding;
     doLayout(frame);
 }
 
-void View::setAttributeImpl(ViewAttributeKey key, std::any value) {
-    _attribMap.insert_or_assign(key, std::move(value));
+void View::setNeedsLayout() {
+    for (View* view = this; view; view = view->parent()) {
+        view->_needsLayout = true;
+        view->_numMeasurements = 0;
+        view->_nextMeasurement = 0;
+        view->invalidateLayoutCache();
+    }
+}
+
+Size View::measure(Size proposal) const {
+    auto begin = _measurements.begin();
+    auto end = begin + _numMeasurements;
+    auto itr = std::find_if(begin, end, [&](Measurement const& m) {
+        return m.proposal == proposal;
+    });
+    if (itr != end) {
+        return itr->size;
+    }
+    Size padding = this->padding();
+    Size content = doMeasure(max(Size(proposal - padding), Size(0)));
+    Size result = clamp(Size(content + padding), minSize(), maxSize());
+    _measurements[_nextMeasurement] = { proposal, result };
+    _nextMeasurement =
+        (uint8_t)((_nextMeasurement + 1) % _measurements.size());
+    _numMeasurements =
+        (uint8_t)std::min<size_t>(_numMeasurements + 1, _measurements.size());
+    return result;
+}
+
+Size View::doMeasure(Size proposal) const {
+    Size result = max(Size(preferredSize() - padding()), Size(0));
+    for (size_t i = 0; i < 2; ++i) {
+        if (_layoutMode[i] == LayoutMode::Flex && std::isfinite(proposal[i])) {
+            result[i] = proposal[i];
+        }
+    }
+    return result;
 }
 
-void View::clearAttributeImpl(ViewAttributeKey key) { _attribMap.erase(key); }
+Size View::padding() const {
+    auto* x = findAttribute<ViewAttributeKey::PaddingX>();
+    auto* y = findAttribute<ViewAttributeKey::PaddingY>();
+    return { x ? 2 * *x : 0, y ? 2 * *y : 0 };
+}
+
+template <EventType ID, size_t Index = 0, auto... DerivedIDs>
+struct DerivedEventTypeListImpl:
+    std::conditional_t<csp::impl::IDIsConcrete<(EventType)Index> &&
+                           csp::impl::ctIsaImpl(ID, (EventType)Index),
+                       DerivedEventTypeListImpl<ID, Index + 1, DerivedIDs...,
+                                                (EventType)Index>,
+                       DerivedEventTypeListImpl<ID, Index + 1, DerivedIDs...>> {
+};
+
+template <EventType ID, auto... DerivedIDs>
+struct DerivedEventTypeListImpl<ID, csp::impl::IDTraits<EventType>::count,
+                                DerivedIDs...> {
+    static constexpr size_t Count = sizeof...(DerivedIDs);
+    static constexpr std::array<EventType, Count> value = { DerivedIDs... };
+};
 
-std::any View::getAttributeImpl(ViewAttributeKey key) const {
-    auto itr = _attribMap.find(key);
-    return itr != _attribMap.end() ? itr->second : std::any();
+template <EventType ID>
+static constexpr auto DerivedEventTypeList =
+    DerivedEventTypeListImpl<ID>::value;
+
+void View::installEventHandler(EventType type,
+                               std::function<bool(EventUnion const&)> handler) {
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        auto makeImpl = []<size_t J>() {
+            return [](View& view,
+                      std::function<bool(EventUnion const&)> const& handler) {
+                auto list = DerivedEventTypeList<(EventType)J>;
+                if (!view._eventHandlers) {
+                    view._eventHandlers =
+                        std::make_unique<EventHandlerTable>();
+                }
+                for (EventType ID: list) {
+                    (*view._eventHandlers)[(size_t)ID] = handler;
+                    view._handledEvents |= eventTypeBit(ID);
+                }
+            };
+        };
+        return std::array { +makeImpl.template operator()<I>()... };
+    }(std::make_index_sequence<csp::impl::IDTraits<EventType>::count>{})[(
+        size_t)type](*this, handler);
 }
 
 void View::setSubviewsWeak(detail::PrivateViewKeyT,
@@ -49,6 +129,26 @@ void View::setSubviewsWeak(detail::PrivateViewKeyT,
     for (auto* view: subviews()) {
         view->_parent = this;
     }
+    setNeedsLayout();
+}
+
+View* View::addSubviewWeak(detail::PrivateViewKeyT,
+                           std::unique_ptr<View> view) {
+    view->_parent = this;
+    _subviews.push_back(std::move(view));
+    return _subviews.back().get();
+}
+
+std::unique_ptr<View> View::removeSubviewWeak(detail::PrivateViewKeyT,
+                                              View* view) {
+    auto itr =
+        std::find_if(_subviews.begin(), _subviews.end(),
+                     [&](auto& subview) { return subview.get() == view; });
+    assert(itr != _subviews.end() && "view is not a subview");
+    auto result = std::move(*itr);
+    _subviews.erase(itr);
+    result->_parent = nullptr;
+    return result;
 }
 
 void View::doLayout(Rect frame) { setFrame(frame); }
@@ -63,7 +163,7 @@ void View::configureDrawingContext(RendererOptions const& options) {
 void View::configureDrawingContext() { configureDrawingContext({}); }
 
 DrawingContext* View::getDrawingContext() {
-    auto ctx = getAttribute<ViewAttributeKey::DrawingContext>();
+    auto* ctx = findAttribute<ViewAttributeKey::DrawingContext>();
     assert(ctx && ctx->get() &&
            "Drawing context must be created with configureDrawingContext()");
     return ctx->get();
@@ -83,40 +183,131 @@ std::unique_ptr<SpacerView> xui::Spacer() {
 
 namespace {
 
+struct ChildrenLayoutOptions {
+    Vec2<bool> fillAvailSpace;
+};
+
+/// What a stack learns about its children along its axis before it distributes
+/// space among them
 struct StackLayoutConstraints {
     size_t numFlexChildren = 0;
-    double totalMinSize = 0;
+    double totalStaticSize = 0;
 };
 
 } // namespace
 
+static constexpr double Unbounded = std::numeric_limits<double>::infinity();
+
+/// \Returns the size that a stack along axis \p A proposes to \p child.
+/// \p flexSize is the share of the stack's space along \p A that each flexible
+/// child gets and \p space is the space of the stack. Children get their ideal
+/// size along static axes and axes that the stack does not fill
+template <Axis A>
+static Size proposeChildSize(View const& child, double flexSize, Size space,
+                             ChildrenLayoutOptions opt) {
+    Size result;
+    for (size_t i = 0; i < 2; ++i) {
+        if (child.layoutMode()[i] == LayoutMode::Static ||
+            !opt.fillAvailSpace[i])
+        {
+            result[i] = Unbounded;
+        }
+        else {
+            result[i] = (Axis)i == A ? flexSize : space[i];
+        }
+    }
+    return result;
+}
+
+template <Axis A>
+static bool isFlexAlong(View const& child, ChildrenLayoutOptions opt) {
+    return child.layoutMode()[A] == LayoutMode::Flex && opt.fillAvailSpace[A];
+}
+
 template <Axis A>
-static StackLayoutConstraints gatherContraints(auto&& children) {
+static StackLayoutConstraints gatherContraints(auto&& children, Size space,
+                                               ChildrenLayoutOptions opt) {
     StackLayoutConstraints result{};
     for (View const* child: children) {
-        switch (child->layoutMode()[A]) {
-        case LayoutMode::Static:
-            result.totalMinSize += child->minSize()[A];
-            break;
-        case LayoutMode::Flex:
+        if (isFlexAlong<A>(*child, opt)) {
             ++result.numFlexChildren;
-            break;
+        }
+        else {
+            Size proposal = proposeChildSize<A>(*child, 0, space, opt);
+            result.totalStaticSize += child->measure(proposal)[A];
         }
     }
     return result;
 }
 
-namespace {
+/// Distributes \p space along axis \p A among \p children and invokes \p fn
+/// with every child and its measured size. Static children get their ideal
+/// size and flexible children share the remaining space equally. Because
+/// measurements are cached per proposal, measuring and then laying out a stack
+/// measures every child only once for each proposal
+template <Axis A>
+static void distributeSpaceXY(auto&& children, Size space,
+                              ChildrenLayoutOptions opt, auto&& fn) {
+    static_assert(A != Axis::Z);
+    auto constraints = gatherContraints<A>(children, space, opt);
+    double flexSize =
+        constraints.numFlexChildren == 0 ?
+            0 :
+            std::max(0.0, space[A] - constraints.totalStaticSize) /
+                (double)constraints.numFlexChildren;
+    for (auto* child: children) {
+        Size proposal = proposeChildSize<A>(*child, flexSize, space, opt);
+        fn(child, child->measure(proposal));
+    }
+}
 
-struct ChildrenLayoutOptions {
-    Vec2<bool> fillAvailSpace;
-};
+/// \Returns the size of \p children stacked along axis \p A in \p space
+template <Axis A>
+static Size measureChildrenXY(auto&& children, Size space,
+                              ChildrenLayoutOptions opt) {
+    Size result{};
+    distributeSpaceXY<A>(children, space, opt,
+                         [&](View const*, Size childSize) {
+        result[A] += childSize[A];
+        result[flip(A)] = std::max(result[flip(A)], childSize[flip(A)]);
+    });
+    return result;
+}
 
-} // namespace
+static Size proposeChildSizeZ(View const& child, Size space) {
+    Size result;
+    for (size_t i = 0; i < 2; ++i) {
+        result[i] = child.layoutMode()[i] == LayoutMode::Static ? Unbounded :
+                                                                  space[i];
+    }
+    return result;
+}
+
+static Size measureChildrenZ(auto&& children, Size space) {
+    Size result{};
+    for (View const* child: children) {
+        result = max(result, child->measure(proposeChildSizeZ(*child, space)));
+    }
+    return result;
+}
+
+/// \Returns \p content where it is larger than \p proposal, and the proposal
+/// along the flexible axes of \p view where it is finite. Containers fill the
+/// space they are offered but do not shrink below their content
+static Size fillProposal(View const& view, Size content, Size proposal) {
+    for (size_t i = 0; i < 2; ++i) {
+        if (view.layoutMode()[i] == LayoutMode::Flex &&
+            std::isfinite(proposal[i]))
+        {
+            content[i] = std::max(content[i], proposal[i]);
+        }
+    }
+    return content;
+}
 
 template <typename T>
-static T orDefault(std::optional<T> const& o) {
-    return o.value_or(T{});
+static T orDefault(T const* value) {
+    return value ? *value : T{};
 }
 
 static double computeAlignedPosition(double childSize, double parentSize,
@@ -143,7 +334,7 @@ static Point computeAlignedPosition(View const& child, Size childSize,
     Point pos{};
     pos[A] = cursor;
     pos[B] = computeAlignedPosition(childSize[B], parentSize[B],
-                                    orDefault(child.getAttribute<Key>()));
+                                    orDefault(child.findAttribute<Key>()));
     return pos;
 }
 
@@ -152,59 +343,35 @@ static Point computeAlignedPositionZ(View const& child, Size childSize,
     return {
         computeAlignedPosition(
             childSize[0], parentSize[0],
-            orDefault(child.getAttribute<ViewAttributeKey::AlignX>())),
+            orDefault(child.findAttribute<ViewAttributeKey::AlignX>())),
         computeAlignedPosition(
             childSize[1], parentSize[1],
-            orDefault(child.getAttribute<ViewAttributeKey::AlignY>())),
+            orDefault(child.findAttribute<ViewAttributeKey::AlignY>())),
     };
 }
 
 template <Axis A>
 static Rect layoutChildrenXY(auto&& children, Rect frame,
                              ChildrenLayoutOptions opt) {
-    static_assert(A != Axis::Z);
-    auto constraints = gatherContraints<A>(children);
-    double flexSpace =
-        std::max(0.0, frame.size()[A] - constraints.totalMinSize);
     double cursor = 0;
     Rect total{};
-    for (View* child: children) {
-        Size prefSize = child->preferredSize();
-        auto layoutMode = child->layoutMode();
-        for (auto [index, mode]: layoutMode | ranges::views::enumerate) {
-            if (mode == LayoutMode::Static || !opt.fillAvailSpace[index]) {
-                continue;
-            }
-            if ((Axis)index == A) {
-                prefSize[index] = flexSpace / constraints.numFlexChildren;
-            }
-            else {
-                prefSize[index] = frame.size()[flip(A)];
-            }
-        }
-        Size childSize = clamp(prefSize, child->minSize(), child->maxSize());
+    distributeSpaceXY<A>(children, frame.size(), opt,
+                         [&](View* child, Size childSize) {
         Point childPosition =
             computeAlignedPosition<A>(*child, childSize, frame.size(), cursor);
         Rect childRect{ childPosition, childSize };
         child->layout(childRect);
         cursor += childSize[A];
         total = merge(total, childRect);
-    }
+    });
     return total;
 }
 
 static Rect layoutChildrenZ(auto&& children, Rect frame) {
     Rect total{};
     for (View* child: children) {
-        Size prefSize = child->preferredSize();
-        auto layoutMode = child->layoutMode();
-        for (auto [index, mode]: layoutMode | ranges::views::enumerate) {
-            if (mode == LayoutMode::Static) {
-                continue;
-            }
-            prefSize[index] = frame.size()[index];
-        }
-        Size childSize = clamp(prefSize, child->minSize(), child->maxSize());
+        Size childSize =
+            child->measure(proposeChildSizeZ(*child, frame.size()));
         Point childPosition =
             computeAlignedPositionZ(*child, childSize, frame.size());
         Rect childRect{ childPosition, childSize };
@@ -214,6 +381,10 @@ static Rect layoutChildrenZ(auto&& children, Rect frame) {
     return total;
 }
 
+static constexpr ChildrenLayoutOptions StackLayoutOptions = {
+    .fillAvailSpace = { true, true }
+};
+
 void StackView::doLayout(Rect frame) {
     setFrame(frame);
     dispatchAxis(axis, [&]<Axis A>(std::integral_constant<Axis, A>) {
@@ -221,12 +392,25 @@ void StackView::doLayout(Rect frame) {
             layoutChildrenZ(subviews(), frame);
         }
         else {
-            layoutChildrenXY<A>(subviews(), frame,
-                                { .fillAvailSpace = { true, true } });
+            layoutChildrenXY<A>(subviews(), frame, StackLayoutOptions);
         }
     });
 }
 
+Size StackView::doMeasure(Size proposal) const {
+    Size content =
+        dispatchAxis(axis, [&]<Axis A>(std::integral_constant<Axis, A>) {
+        if constexpr (A == Axis::Z) {
+            return measureChildrenZ(subviews(), proposal);
+        }
+        else {
+            return measureChildrenXY<A>(subviews(), proposal,
+                                        StackLayoutOptions);
+        }
+    });
+    return fillProposal(*this, content, proposal);
+}
+
 std::unique_ptr<StackView> xui::HStack(UniqueVector<View> children) {
     return std::make_unique<StackView>(Axis::X, std::move(children));
 }
@@ -239,6 +423,13 @@ std::unique_ptr<StackView> xui::ZStack(UniqueVector<View> children) {
     return std::make_unique<StackView>(Axis::Z, std::move(children));
 }
 
+/// Scroll views fill their space across the scroll axis \p A and give their
+/// children their ideal size along it
+template <Axis A>
+static constexpr ChildrenLayoutOptions ScrollLayoutOptions = {
+    .fillAvailSpace{ flip(A), true }
+};
+
 void ScrollView::doLayout(Rect frame) {
     setFrame(frame);
     dispatchAxis(axis, [&]<Axis A>(std::integral_constant<Axis, A>) {
@@ -246,14 +437,34 @@ void ScrollView::doLayout(Rect frame) {
             assert(false);
         }
         else {
-            Rect total =
-                layoutChildrenXY<A>(subviews(), frame,
-                                    { .fillAvailSpace{ flip(A), true } });
+            Rect total = layoutChildrenXY<A>(subviews(), frame,
+                                             ScrollLayoutOptions<A>);
             setDocumentSize(max(total.size(), frame.size()));
         }
     });
 }
 
+Size ScrollView::doMeasure(Size proposal) const {
+    Size content =
+        dispatchAxis(axis, [&]<Axis A>(std::integral_constant<Axis, A>) {
+        if constexpr (A == Axis::Z) {
+            assert(false);
+            return Size{};
+        }
+        else {
+            Size result = measureChildrenXY<A>(subviews(), proposal,
+                                               ScrollLayoutOptions<A>);
+            // The content scrolls, so along the scroll axis any finite
+            // proposal fits
+            if (std::isfinite(proposal[A])) {
+                result[A] = proposal[A];
+            }
+            return result;
+        }
+    });
+    return fillProposal(*this, content, proposal);
+}
+
 bool ScrollView::setFrame(Rect frame) {
     if (View::setFrame(frame)) {
         setDocumentSize(frame.size());
@@ -270,6 +481,189 @@ std::unique_ptr<ScrollView> xui::HScrollView(UniqueVector<View> children) {
     return std::make_unique<ScrollView>(Axis::X, std::move(children));
 }
 
+LazyListView::LazyListView(Axis axis, size_t numRows,
+                           SizeEstimator estimateSize, RowFactory makeRow):
+    ScrollView(axis, {}),
+    estimateSize(std::move(estimateSize)),
+    makeRow(std::move(makeRow)),
+    _numRows(numRows) {
+    assert(axis != Axis::Z && "Lazy lists scroll along X or Y");
+    reloadData();
+}
+
+void LazyListView::setNumRows(size_t count) {
+    _numRows = count;
+    reloadData();
+}
+
+void LazyListView::reloadData() {
+    for (auto* row: rows) {
+        recycleRow(row);
+    }
+    rows.clear();
+    firstRow = 0;
+    rowSizes.resize(_numRows);
+    for (size_t i = 0; i < _numRows; ++i) {
+        rowSizes[i] = estimateSize(i);
+    }
+    rowOffsets.resize(_numRows + 1);
+    firstStaleOffset = 0;
+    setNeedsLayout();
+}
+
+void LazyListView::setOverscan(double value) {
+    _overscan = value;
+    setNeedsLayout();
+}
+
+void LazyListView::doLayout(Rect frame) {
+    // `ScrollView::setFrame()` shrinks the document to the frame, which would
+    // lose the scroll position. `updateRows()` sets the document size instead
+    View::setFrame(frame);
+    updateRows();
+}
+
+Size LazyListView::doMeasure(Size proposal) const {
+    Axis A = scrollAxis();
+    Size content = {};
+    // Like any scroll view we fit into finite proposals. Otherwise we want the
+    // space of all rows
+    content[A] =
+        std::isfinite(proposal[A]) ? proposal[A] : rowOffset(_numRows);
+    return fillProposal(*this, content, proposal);
+}
+
+void LazyListView::didScroll() { updateRows(); }
+
+double LazyListView::rowOffset(size_t index) const {
+    if (index > firstStaleOffset) {
+        updateOffsets();
+    }
+    return rowOffsets[index];
+}
+
+void LazyListView::updateOffsets() const {
+    for (size_t i = firstStaleOffset; i < _numRows; ++i) {
+        rowOffsets[i + 1] = rowOffsets[i] + rowSizes[i];
+    }
+    firstStaleOffset = _numRows;
+}
+
+void LazyListView::recycleRow(View* row) {
+    reusePool.push_back(removeDocumentSubview(row));
+}
+
+std::unique_ptr<View> LazyListView::makeRowView(size_t index) {
+    std::unique_ptr<View> reusable;
+    if (!reusePool.empty()) {
+        reusable = std::move(reusePool.back());
+        reusePool.pop_back();
+    }
+    auto row = makeRow(index, std::move(reusable));
+    assert(row && "Row factory must return a view");
+    return row;
+}
+
+void LazyListView::updateRows() {
+    if (isUpdatingRows) {
+        return;
+    }
+    isUpdatingRows = true;
+    Axis A = scrollAxis();
+    Rect visible = visibleRect();
+    double begin = visible.origin()[A] - _overscan;
+    double end = visible.origin()[A] + visible.size()[A] + _overscan;
+    Size proposal = size();
+    proposal[A] = Unbounded;
+    // Measuring new rows may replace estimates and move the visible range, so
+    // we repeat until all rows in the range have their measured size. Every
+    // row changes its size at most once, so this terminates
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        updateOffsets();
+        auto offsetsEnd = rowOffsets.begin() + (ptrdiff_t)_numRows;
+        size_t first = (size_t)std::max<ptrdiff_t>(
+            std::upper_bound(rowOffsets.begin(), offsetsEnd, begin) -
+                rowOffsets.begin() - 1,
+            0);
+        size_t last =
+            (size_t)(std::lower_bound(rowOffsets.begin(), offsetsEnd, end) -
+                     rowOffsets.begin());
+        first = std::min(first, last);
+        // Rows that left the range go to the pool first, so the rows that
+        // entered it can reuse them
+        for (size_t i = 0; i < rows.size(); ++i) {
+            size_t index = firstRow + i;
+            if (index < first || index >= last) {
+                recycleRow(rows[i]);
+            }
+        }
+        nextRows.clear();
+        for (size_t index = first; index < last; ++index) {
+            if (index >= firstRow && index < firstRow + rows.size()) {
+                nextRows.push_back(rows[index - firstRow]);
+            }
+            else {
+                nextRows.push_back(addDocumentSubview(makeRowView(index)));
+            }
+        }
+        std::swap(rows, nextRows);
+        firstRow = first;
+        for (size_t i = 0; i < rows.size(); ++i) {
+            size_t index = firstRow + i;
+            double rowSize = rows[i]->measure(proposal)[A];
+            if (rowSize != rowSizes[index]) {
+                rowSizes[index] = rowSize;
+                firstStaleOffset = std::min(firstStaleOffset, index);
+                changed = true;
+            }
+        }
+    }
+    Size documentSize = size();
+    documentSize[A] = std::max(rowOffset(_numRows), documentSize[A]);
+    setDocumentSize(documentSize);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        size_t index = firstRow + i;
+        Rect frame = { Point(A, rowOffset(index)), size() };
+        frame.size()[A] = rowSizes[index];
+        rows[i]->layout(frame);
+    }
+    isUpdatingRows = false;
+}
+
+std::unique_ptr<LazyListView> xui::VLazyList(
+    size_t numRows, LazyListView::SizeEstimator estimate,
+    LazyListView::RowFactory makeRow) {
+    return std::make_unique<LazyListView>(Axis::Y, numRows, std::move(estimate),
+                                          std::move(makeRow));
+}
+
+std::unique_ptr<LazyListView> xui::HLazyList(
+    size_t numRows, LazyListView::SizeEstimator estimate,
+    LazyListView::RowFactory makeRow) {
+    return std::make_unique<LazyListView>(Axis::X, numRows, std::move(estimate),
+                                          std::move(makeRow));
+}
+
+/// Split views are at least as large as the minimums of their children and
+/// ideally as large as their ideal sizes. Fractions only matter for layout
+Size SplitView::doMeasure(Size proposal) const {
+    Size content{};
+    for (View const* child: subviews()) {
+        Size childProposal = proposal;
+        childProposal[axis] = std::isfinite(proposal[axis]) ? 0 : Unbounded;
+        Size childSize = child->measure(childProposal);
+        content[axis] += childSize[axis];
+        content[flip(axis)] = std::max(content[flip(axis)],
+                                       childSize[flip(axis)]);
+    }
+    if (numSubviews() > 1) {
+        content[axis] += dividerThickness() * (double)(numSubviews() - 1);
+    }
+    return fillProposal(*this, content, proposal);
+}
+
 std::unique_ptr<SplitView> xui::HSplit(UniqueVector<View> children) {
     return std::make_unique<SplitView>(Axis::X, std::move(children));
 }
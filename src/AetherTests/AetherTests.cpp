@@ -0,0 +1,28 @@
+#include <iostream>
+
+#include "Tests.h"
+
+namespace {
+
+struct Test {
+    char const* name;
+    bool (*run)();
+};
+
+} // namespace
+
+static constexpr Test Tests[] = {
+    { "MeasureCache", testMeasureCache },
+    { "Triangulation", testTriangulation },
+    { "RepeatedPoints", testRepeatedPoints },
+};
+
+int main() {
+    int numFailed = 0;
+    for (auto& test: Tests) {
+        bool passed = test.run();
+        std::cout << (passed ? "[pass] " : "[FAIL] ") << test.name << "\n";
+        numFailed += !passed;
+    }
+    return numFailed == 0 ? 0 : 1;
+}
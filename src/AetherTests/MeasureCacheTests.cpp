@@ -0,0 +1,55 @@
+#include <iostream>
+
+#include <Aether/View.h>
+
+#include "Tests.h"
+
+using namespace xui;
+
+namespace {
+
+/// Leaf view that counts how often it is measured
+class MeasuredView: public View {
+public:
+    MeasuredView():
+        View({ .minSize = { 40, 20 },
+               .layoutModeX = LayoutMode::Flex,
+               .layoutModeY = LayoutMode::Flex }) {}
+
+    mutable size_t numMeasures = 0;
+
+private:
+    Size doMeasure(Size proposal) const override {
+        ++numMeasures;
+        return proposal;
+    }
+};
+
+} // namespace
+
+bool testMeasureCache() {
+    MeasuredView view;
+    auto measureAll = [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            view.measure({ 100.0 + (double)i, 50 });
+        }
+    };
+    // Four proposals fit into the cache
+    measureAll(0, 4);
+    measureAll(0, 4);
+    bool ok = view.numMeasures == 4;
+    // The fifth proposal evicts the oldest, the other three stay cached
+    measureAll(4, 5);
+    measureAll(2, 5);
+    ok &= view.numMeasures == 5;
+    // Invalidation clears the cache
+    view.setNeedsLayout();
+    measureAll(0, 4);
+    measureAll(0, 4);
+    ok &= view.numMeasures == 9;
+    if (!ok) {
+        std::cerr << "Measure cache check failed: " << view.numMeasures
+                  << " calls to doMeasure(), expected 9\n";
+    }
+    return ok;
+}
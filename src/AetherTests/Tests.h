@@ -0,0 +1,18 @@
+#ifndef AETHERTESTS_TESTS_H
+#define AETHERTESTS_TESTS_H
+
+/// Every test \Returns `false` and prints a message if it fails
+
+/// Checks that `View::measure()` computes each proposal only once while it
+/// fits into the cache
+bool testMeasureCache();
+
+/// Checks that the default triangulation covers the area of convex,
+/// non-monotone and holed polygons
+bool testTriangulation();
+
+/// Checks that the default triangulation ignores repeated points, including a
+/// repeated closing point
+bool testRepeatedPoints();
+
+#endif // AETHERTESTS_TESTS_H
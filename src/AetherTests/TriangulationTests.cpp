@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <span>
+#include <vector>
+
+#include <Aether/Shapes.h>
+
+#include "Tests.h"
+
+using namespace xui;
+using namespace vml::short_types;
+
+/// \Returns the summed area of the triangles \p indices, or NaN if an index is
+/// out of range
+static double triangleArea(std::span<float2 const> vertices,
+                           std::span<uint32_t const> indices) {
+    double area = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        if (std::max({ indices[i], indices[i + 1], indices[i + 2] }) >=
+            vertices.size())
+        {
+            return NAN;
+        }
+        float2 a = vertices[indices[i]], b = vertices[indices[i + 1]],
+               c = vertices[indices[i + 2]];
+        area += std::abs((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+    }
+    return area / 2;
+}
+
+/// Triangulates \p contours with the default options and checks that the
+/// triangles cover \p expectedArea
+static bool checkArea(char const* name,
+                      std::span<std::span<float2 const> const> contours,
+                      double expectedArea) {
+    std::vector<float2> vertices;
+    for (auto contour: contours) {
+        vertices.insert(vertices.end(), contour.begin(), contour.end());
+    }
+    std::vector<uint32_t> indices(
+        polygonIndexCount(vertices.size(), contours.size()));
+    indices.resize(triangulatePolygonInto(contours, indices));
+    double area = triangleArea(vertices, indices);
+    if (area != expectedArea) {
+        std::cerr << "Triangulation of " << name << " covers an area of "
+                  << area << ", expected " << expectedArea << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// \overload
+static bool checkArea(char const* name, std::span<float2 const> polygon,
+                      double expectedArea) {
+    return checkArea(name, { &polygon, 1 }, expectedArea);
+}
+
+bool testTriangulation() {
+    std::vector<float2> square = { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } };
+    std::vector<float2> hole = { { 1, 1 }, { 1, 3 }, { 3, 3 }, { 3, 1 } };
+    // Not Y monotone, so diagonals are inserted before triangulating
+    std::vector<float2> crown = { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 7, 4 },
+                                  { 5, 10 }, { 3, 4 },  { 0, 10 } };
+    std::span<float2 const> squareWithHole[] = { square, hole };
+    std::span<float2 const> crownWithHole[] = { crown, hole };
+    bool ok = checkArea("a square", square, 100);
+    ok &= checkArea("a square with a hole", squareWithHole, 96);
+    ok &= checkArea("a non-monotone polygon", crown, 70);
+    ok &= checkArea("a non-monotone polygon with a hole", crownWithHole, 66);
+    return ok;
+}
+
+bool testRepeatedPoints() {
+    std::vector<float2> square = { { 0, 0 },   { 10, 0 }, { 10, 0 },
+                                   { 10, 10 }, { 0, 10 }, { 0, 0 } };
+    std::vector<float2> hole = { { 2, 2 }, { 2, 2 }, { 2, 4 }, { 4, 4 },
+                                 { 4, 2 }, { 2, 2 } };
+    std::vector<float2> crown = { { 0, 0 },  { 10, 0 }, { 10, 10 }, { 10, 10 },
+                                  { 7, 4 },  { 5, 10 }, { 3, 4 },   { 3, 4 },
+                                  { 0, 10 }, { 0, 0 } };
+    std::vector<uint32_t> indices(polygonIndexCount(square.size()));
+    indices.resize(triangulatePolygonInto(square, indices));
+    bool ok = indices.size() == 6;
+    if (!ok) {
+        std::cerr << "Triangulation of a square with repeated points emitted "
+                  << indices.size() / 3 << " triangles, expected 2\n";
+    }
+    std::span<float2 const> squareWithHole[] = { square, hole };
+    ok &= checkArea("a square with repeated points", square, 100);
+    ok &= checkArea("a hole with repeated points", squareWithHole, 96);
+    ok &= checkArea("a non-monotone polygon with repeated points", crown,
+                    70);
+    return ok;
+}
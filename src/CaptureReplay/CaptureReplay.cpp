@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <Aether/FrameCapture.h>
+#include <Aether/SoftwareRenderer.h>
+
+using namespace xui;
+
+namespace {
+
+struct Config {
+    std::string capture;
+    std::string dump;
+    size_t width = 1280, height = 800;
+    float scale = 1;
+    size_t numThreads = 0;
+    size_t repeat = 1;
+    bool json = false;
+};
+
+struct FrameResult {
+    size_t numDrawCalls = 0;
+    size_t numVertices = 0;
+    size_t numTriangles = 0;
+    double seconds = 0;
+};
+
+} // namespace
+
+static size_t numTriangles(DrawData const& data) {
+    size_t count = 0;
+    for (auto& dc: data.drawCalls) {
+        size_t instances = dc.instanced() ? dc.endInstance - dc.beginInstance :
+                                            1;
+        count += (dc.endIndex - dc.beginIndex) / 3 * instances;
+    }
+    return count;
+}
+
+/// Renders \p data \p repeat times and returns the fastest run
+static FrameResult replayFrame(Renderer& renderer, DrawData const& data,
+                               size_t repeat) {
+    using Clock = std::chrono::steady_clock;
+    FrameResult result = { .numDrawCalls = data.drawCalls.size(),
+                           .numVertices = data.vertices.size(),
+                           .numTriangles = numTriangles(data),
+                           .seconds = INFINITY };
+    for (size_t i = 0; i < repeat; ++i) {
+        auto begin = Clock::now();
+        renderer.render(data);
+        double seconds =
+            std::chrono::duration<double>(Clock::now() - begin).count();
+        result.seconds = std::min(result.seconds, seconds);
+    }
+    return result;
+}
+
+/// Writes the image of \p renderer as a PAM file, which most image viewers
+/// and converters read
+static bool writeImage(SoftwareRenderer const& renderer,
+                       std::string const& path) {
+    std::ofstream file(path, std::ios::binary);
+    file << "P7\nWIDTH " << renderer.width() << "\nHEIGHT "
+         << renderer.height()
+         << "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    auto pixels = renderer.pixels();
+    file.write(reinterpret_cast<char const*>(pixels.data()),
+               (std::streamsize)pixels.size());
+    return file.good();
+}
+
+static void printTableHeader() {
+    std::cout << std::right << std::setw(8) << "Frame" << std::setw(12)
+              << "Draw calls" << std::setw(12) << "Vertices" << std::setw(12)
+              << "Triangles" << std::setw(12) << "Time [ms]" << "\n";
+}
+
+static void printTableRow(size_t index, FrameResult const& result) {
+    std::cout << std::right << std::setw(8) << index << std::setw(12)
+              << result.numDrawCalls << std::setw(12) << result.numVertices
+              << std::setw(12) << result.numTriangles << std::fixed
+              << std::setprecision(3) << std::setw(12)
+              << result.seconds * 1000 << "\n";
+}
+
+/// Prints one JSON object per line, like the output of ShapesBench
+static void printJSON(size_t index, FrameResult const& result) {
+    std::cout << std::setprecision(9) << "{\"frame\":" << index
+              << ",\"drawCalls\":" << result.numDrawCalls
+              << ",\"vertices\":" << result.numVertices
+              << ",\"triangles\":" << result.numTriangles
+              << ",\"seconds\":" << result.seconds << "}\n";
+}
+
+static void printUsage(char const* program) {
+    std::cerr << "Usage: " << program
+              << " <capture> [--size <width>x<height>] [--scale <factor>]"
+                 " [--threads <count>] [--repeat <count>] [--json]"
+                 " [--dump <image.pam>]\n";
+}
+
+static bool parseSize(char const* arg, size_t& width, size_t& height) {
+    char* end = nullptr;
+    width = std::strtoul(arg, &end, 10);
+    if (*end != 'x') {
+        return false;
+    }
+    height = std::strtoul(end + 1, &end, 10);
+    return *end == '\0' && width > 0 && height > 0;
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            config.json = true;
+        }
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc &&
+                 parseSize(argv[i + 1], config.width, config.height))
+        {
+            ++i;
+        }
+        else if (std::strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            config.scale = (float)std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.numThreads = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            config.repeat = std::max<size_t>(
+                std::strtoul(argv[++i], nullptr, 10), 1);
+        }
+        else if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc) {
+            config.dump = argv[++i];
+        }
+        else if (argv[i][0] != '-' && config.capture.empty()) {
+            config.capture = argv[i];
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.capture.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    FrameCaptureReader reader(config.capture);
+    if (!reader.isOpen()) {
+        std::cerr << "Cannot read capture " << config.capture << "\n";
+        return 1;
+    }
+    SoftwareRenderer renderer(config.width, config.height, {},
+                              config.numThreads);
+    renderer.setScale(config.scale);
+    if (!config.json) {
+        printTableHeader();
+    }
+    CapturedFrame frame;
+    size_t index = 0;
+    double total = 0;
+    for (; reader.read(frame); ++index) {
+        auto result = replayFrame(renderer, frame.drawData(), config.repeat);
+        total += result.seconds;
+        if (config.json) {
+            printJSON(index, result);
+        }
+        else {
+            printTableRow(index, result);
+        }
+    }
+    if (!reader.isOpen()) {
+        std::cerr << "Capture is malformed after frame " << index << "\n";
+        return 1;
+    }
+    if (!config.json) {
+        std::cout << index << " frames, " << std::fixed << std::setprecision(3)
+                  << total * 1000 << " ms\n";
+    }
+    if (!config.dump.empty() && !writeImage(renderer, config.dump)) {
+        std::cerr << "Cannot write image " << config.dump << "\n";
+        return 1;
+    }
+}
@@ -1,6 +1,9 @@
 #include "Flow/Editor.h"
 
+#include <bit>
+#include <memory_resource>
 #include <optional>
+#include <vector>
 
 #include <Aether/DrawingContext.h>
 #include <Aether/Shapes.h>
@@ -15,40 +18,46 @@ using namespace vml::short_types;
 float const CornerRadius = 10;
 float const PinSize = 15;
 float const PinRadius = 5;
+/// Maximum deviation in pixels of flattened curves from the exact curves
+float const CurveTolerance = 0.25;
 
 static xui::Size computeNodeSize(Node const&) { return { 200, 100 }; }
 
-static std::vector<float2> nodeShape(Node const& node, Size size) {
-    std::vector<float2> result;
+/// \Returns the outline of \p node, allocated from \p memory
+static std::pmr::vector<float2> nodeShape(Node const& node, Size size,
+                                          std::pmr::memory_resource* memory) {
+    std::pmr::vector<float2> result(memory);
 
     auto vertexEmitter = [&](float2 v) { result.push_back(v); };
     static constexpr float pi = vml::constants<float>::pi;
+    CircleSegmentOptions const corner = { .orientation = Orientation::Clockwise,
+                                          .tolerance = CurveTolerance };
+    CircleSegmentOptions const pinNotch = { .tolerance = CurveTolerance };
     pathCircleSegment({ 0, CornerRadius }, { CornerRadius, CornerRadius },
-                      pi / 2, vertexEmitter,
-                      { .orientation = Orientation::Clockwise });
+                      pi / 2, vertexEmitter, corner);
     pathCircleSegment({ size.width() - CornerRadius, 0 },
                       { size.width() - CornerRadius, CornerRadius }, pi / 2,
-                      vertexEmitter, { .orientation = Orientation::Clockwise });
+                      vertexEmitter, corner);
     double cursor = CornerRadius;
     for ([[maybe_unused]] auto* pin: node.outputs()) {
         pathCircleSegment({ size.width(), cursor + PinSize / 2 - PinRadius },
                           { size.width(), cursor + PinSize / 2 }, pi,
-                          vertexEmitter);
+                          vertexEmitter, pinNotch);
         cursor += PinSize;
     }
     pathCircleSegment(float2{ size.width(), size.height() - CornerRadius },
                       float2(size.width(), size.height()) -
                           float2(CornerRadius),
-                      pi / 2, vertexEmitter,
-                      { .orientation = Orientation::Clockwise });
+                      pi / 2, vertexEmitter, corner);
     vertexEmitter({ size.width() - CornerRadius, size.height() });
     pathCircleSegment({ CornerRadius, size.height() },
                       { CornerRadius, size.height() - CornerRadius }, pi / 2,
-                      vertexEmitter, { .orientation = Orientation::Clockwise });
+                      vertexEmitter, corner);
     cursor = CornerRadius + PinSize * node.inputs().size();
     for ([[maybe_unused]] auto* pin: node.inputs()) {
         pathCircleSegment({ 0, cursor - PinSize / 2 + PinRadius },
-                          { 0, cursor - PinSize / 2 }, pi, vertexEmitter);
+                          { 0, cursor - PinSize / 2 }, pi, vertexEmitter,
+                          pinNotch);
         cursor -= PinSize;
     }
     return result;
@@ -87,6 +96,7 @@ private:
     bool onEvent(MouseDragEvent const& e) override {
         if (e.mouseButton() != MouseButton::Left) return false;
         node().setPosition(node().position() + e.delta());
+        parent()->setNeedsLayout();
         parent()->layout(parent()->frame());
         return true;
     }
@@ -107,13 +117,16 @@ void NodeView::doLayout(xui::Rect frame) {
 
 void NodeView::draw(xui::Rect) {
     auto* ctx = getDrawingContext();
-    auto shape = nodeShape(node(), size());
-    ctx->addPolygon(shape,
-                    { .fill = Gradient{ .begin{ { 0, 0 }, Color::Orange() },
-                                        .end{ { 0, 2 * size().height() },
-                                              Color::Red() } } },
-                    { .isYMonotone = true,
-                      .orientation = Orientation::Counterclockwise });
+    {
+        // The shape lives in frame memory and must be gone before `draw()`
+        auto shape = nodeShape(node(), size(), &ctx->frameArena());
+        ctx->addPolygon(shape,
+                        { .fill = Gradient{ .begin{ { 0, 0 }, Color::Orange() },
+                                            .end{ { 0, 2 * size().height() },
+                                                  Color::Red() } } },
+                        { .isYMonotone = true,
+                          .orientation = Orientation::Counterclockwise });
+    }
     ctx->draw();
 }
 
@@ -138,6 +151,15 @@ private:
 
     void drawLines(DrawingContext* ctx);
 
+    /// A link between an output pin and the input pin \p input
+    struct Link {
+        InputPin const* input;
+        CubicBezier curve;
+    };
+
+    void addLines(DrawingContext* ctx, std::span<Link const> links);
+
+    /// \Returns the location of \p pin in surface coordinates
     Point getPinLocation(Pin const& pin) const;
 
     EditorView& editor;
@@ -176,38 +198,71 @@ void NodeLayerView::draw(xui::Rect) {
     ctx->draw();
 }
 
-static void drawLine(DrawingContext* ctx, vml::float2 begin, vml::float2 end) {
-    static constexpr size_t NumSegments = 20;
-    std::array<float2, NumSegments + 1> vertices;
+static CubicBezier makeLineCurve(vml::float2 begin, vml::float2 end) {
     float yDiff = std::abs(begin.y - end.y);
     float curve = 200 * 2 * std::atan(yDiff / 200) / vml::constants<float>::pi;
-    pathBezier({ { begin, begin + float2(curve, 0), end - float2(curve, 0),
-                   end } },
-               [&, i = size_t{ 0 }](float2 p) mutable { vertices[i++] = p; },
-               { .numSegments = NumSegments });
-    ctx->addLine(vertices, { .fill = FlatColor(Color::Black()) },
-                 { .width = 3,
-                   .beginCap = { LineCapOptions::Circle },
-                   .endCap = { LineCapOptions::Circle } });
+    return { begin, begin + float2(curve, 0), end - float2(curve, 0), end };
+}
+
+/// \Returns a hash of the control points of \p curve. Used as the version of
+/// the retained geometry of a link
+static uint64_t hashCurve(CubicBezier const& curve) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (float2 p: curve) {
+        for (float value: { p.x, p.y }) {
+            hash ^= std::bit_cast<uint32_t>(value);
+            hash *= 0x100000001b3;
+        }
+    }
+    return hash;
 }
 
 void NodeLayerView::drawLines(DrawingContext* ctx) {
     assert(graph);
+    // Links are built in surface coordinates, so panning only changes the
+    // transform and the retained link geometry is reused
+    std::pmr::vector<Link> links(&ctx->frameArena());
     for (auto* node: graph->nodes()) {
         for (auto* input: node->inputs()) {
             auto* source = input->source();
             if (!source) continue;
             float2 begin = (Vec2<double>)getPinLocation(*source);
             float2 end = (Vec2<double>)getPinLocation(*input);
-            drawLine(ctx, begin, end);
+            links.push_back({ input, makeLineCurve(begin, end) });
         }
     }
+    float2 origin = (Vec2<double>)editor.surfaceOrigin();
+    ctx->pushTransform(Transform2D::Translation(origin));
+    addLines(ctx, links);
+    ctx->popTransform();
+}
+
+void NodeLayerView::addLines(DrawingContext* ctx,
+                             std::span<Link const> links) {
+    BezierOptions const options = { .tolerance = CurveTolerance };
+    // Every link is a retained item keyed by its input pin, so only the links
+    // of moved nodes are tessellated again
+    ctx->recordParallel(links.size(), [&](DrawingContext& shard, size_t i) {
+        auto& link = links[i];
+        uint64_t key = reinterpret_cast<uintptr_t>(link.input);
+        shard.recordItem(key, hashCurve(link.curve), [&] {
+            size_t count = bezierVertexCount(link.curve, options);
+            std::pmr::vector<float2> vertices(count, &shard.frameArena());
+            pathBeziers({ &link.curve, 1 }, vertices, {}, options);
+            shard.addLine(vertices,
+                          { .fill = FlatColor(Color::Black()),
+                            .fringeWidth = 1 },
+                          { .width = 3,
+                            .beginCap = { LineCapOptions::Circle },
+                            .endCap = { LineCapOptions::Circle } });
+        });
+    });
 }
 
 Point NodeLayerView::getPinLocation(Pin const& pin) const {
     auto* node = pin.node();
     auto* nodeView = getNodeView(node);
-    Point nodePos = node->position() + editor.surfaceOrigin();
+    Point nodePos = node->position();
     // clang-format off
     return visit(pin, csp::overload{
         [&](InputPin const& pin) {
@@ -312,5 +367,6 @@ bool EditorView::onEvent(MouseDragEvent const& e) {
 
 void EditorView::addOriginDelta(Vec2<double> delta) {
     _origin += delta;
+    nodeLayer->setNeedsLayout();
     layout(frame());
 }
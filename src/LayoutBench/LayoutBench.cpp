@@ -0,0 +1,275 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Aether/View.h>
+
+using namespace xui;
+
+namespace {
+
+/// Amount of layout work a single run of a benchmark does
+struct Work {
+    size_t numViews = 0;
+    size_t numLayouts = 0;
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<Work()> run;
+};
+
+struct Result {
+    std::string name;
+    Work work;
+    double seconds = 0;
+    size_t iterations = 0;
+};
+
+struct Config {
+    bool json = false;
+    std::string filter;
+    double minTime = 0.5;
+};
+
+/// Number of calls to `doLayout()` of leaf views. Reset before every run
+size_t numLeafLayouts = 0;
+
+/// Keeps the compiler from discarding attribute reads
+double attributeSink = 0;
+
+/// Leaf view that counts how often it is laid out
+class LeafView: public View {
+public:
+    LeafView():
+        View({ .minSize = { 40, 20 },
+               .layoutModeX = LayoutMode::Flex,
+               .layoutModeY = LayoutMode::Static }) {}
+
+private:
+    void doLayout(Rect frame) override {
+        setFrame(frame);
+        ++numLeafLayouts;
+    }
+};
+
+/// A view hierarchy similar to an inspector panel: a split view with a
+/// scrolling list of rows on each side
+struct Tree {
+    std::unique_ptr<View> root;
+    std::vector<View*> leaves;
+    size_t numViews = 0;
+};
+
+} // namespace
+
+static std::unique_ptr<View> makeList(Tree& tree, size_t numRows,
+                                      size_t numColumns) {
+    UniqueVector<View> rows;
+    for (size_t i = 0; i < numRows; ++i) {
+        UniqueVector<View> columns;
+        for (size_t j = 0; j < numColumns; ++j) {
+            auto leaf = std::make_unique<LeafView>();
+            tree.leaves.push_back(leaf.get());
+            columns.push_back(std::move(leaf));
+        }
+        tree.numViews += numColumns + 1;
+        rows.push_back(HStack(std::move(columns)));
+    }
+    tree.numViews += 2;
+    return VScrollView({ VStack(std::move(rows)) });
+}
+
+static std::shared_ptr<Tree> makeTree(size_t numRows, size_t numColumns) {
+    auto tree = std::make_shared<Tree>();
+    auto left = makeList(*tree, numRows, numColumns);
+    auto right = makeList(*tree, numRows, numColumns);
+    tree->root = HSplit({ std::move(left), std::move(right) });
+    tree->numViews += 1;
+    return tree;
+}
+
+static Rect const WindowFrame = { { 0, 0 }, { 1200, 800 } };
+
+/// Lazy list of leaf rows that reuses rows scrolled out of view
+static std::shared_ptr<LazyListView> makeLazyList(size_t numRows) {
+    return VLazyList(
+        numRows, [](size_t) { return 20.0; },
+        [](size_t, std::unique_ptr<View> reusable) -> std::unique_ptr<View> {
+        if (reusable) {
+            return reusable;
+        }
+        return std::make_unique<LeafView>();
+    });
+}
+
+static std::vector<Benchmark> makeBenchmarks() {
+    std::vector<Benchmark> result;
+    for (size_t numRows: { 100, 1000, 10000 }) {
+        std::string suffix = "/rows=" + std::to_string(numRows);
+        auto tree = makeTree(numRows, 4);
+        tree->root->layout(WindowFrame);
+        // Resizing the window changes every frame in the tree
+        auto resize = [tree, wide = false]() mutable {
+            wide = !wide;
+            Rect frame = WindowFrame;
+            frame.width() += wide ? 1 : 0;
+            tree->root->layout(frame);
+            return Work{ tree->numViews, numLeafLayouts };
+        };
+        // Nothing changed, so layout must return immediately
+        auto clean = [tree] {
+            tree->root->layout(WindowFrame);
+            return Work{ tree->numViews, numLeafLayouts };
+        };
+        // A single leaf changes its minimum size, so only the path to the root
+        // and the siblings along that path are laid out again
+        auto invalidateLeaf = [tree, tall = false]() mutable {
+            tall = !tall;
+            auto* leaf = tree->leaves[tree->leaves.size() / 2];
+            leaf->setMinHeight(tall ? 21 : 20);
+            tree->root->layout(WindowFrame);
+            return Work{ tree->numViews, numLeafLayouts };
+        };
+        result.push_back({ "layout/resize" + suffix, resize });
+        result.push_back({ "layout/clean" + suffix, clean });
+        result.push_back({ "layout/invalidate-leaf" + suffix, invalidateLeaf });
+    }
+    for (size_t numRows: { 100, 1000 }) {
+        std::string suffix = "/rows=" + std::to_string(numRows);
+        auto tree = makeTree(numRows, 4);
+        // Every other leaf has padding and alignment like a typical form
+        for (size_t i = 0; i < tree->leaves.size(); i += 2) {
+            auto* leaf = tree->leaves[i];
+            leaf->setAttribute<ViewAttributeKey::PaddingX>(4);
+            leaf->setAttribute<ViewAttributeKey::AlignY>(AlignY::Center);
+        }
+        // The attribute reads that layout does, without the layout itself
+        auto read = [tree] {
+            double sum = 0;
+            for (auto* leaf: tree->leaves) {
+                using enum ViewAttributeKey;
+                auto* padX = leaf->findAttribute<PaddingX>();
+                auto* padY = leaf->findAttribute<PaddingY>();
+                auto* alignX = leaf->findAttribute<AlignX>();
+                auto* alignY = leaf->findAttribute<AlignY>();
+                sum += (padX ? *padX : 0) + (padY ? *padY : 0);
+                sum += (alignX ? (double)*alignX : 0) +
+                       (alignY ? (double)*alignY : 0);
+            }
+            attributeSink += sum;
+            return Work{ tree->numViews, numLeafLayouts };
+        };
+        result.push_back({ "attributes/read" + suffix, read });
+    }
+    for (size_t numRows: { 1000, 100000 }) {
+        std::string suffix = "/rows=" + std::to_string(numRows);
+        auto list = makeLazyList(numRows);
+        list->layout(WindowFrame);
+        // Scrolling by less than a page materializes the rows that scroll into
+        // view and recycles the rows that scroll out of view
+        auto scroll = [list, offset = 0.0]() mutable {
+            double maxOffset = 20.0 * (double)list->numRows() - 800;
+            offset = offset + 300 > maxOffset ? 0 : offset + 300;
+            list->scrollTo({ 0, offset });
+            return Work{ list->numVisibleRows() + 1, numLeafLayouts };
+        };
+        result.push_back({ "lazylist/scroll" + suffix, scroll });
+    }
+    return result;
+}
+
+/// Runs \p bench repeatedly for at least \p minTime seconds and records the
+/// fastest run
+static Result runBenchmark(Benchmark const& bench, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    Result result = { .name = bench.name };
+    double best = INFINITY;
+    double total = 0;
+    while (total < minTime || result.iterations < 3) {
+        numLeafLayouts = 0;
+        auto begin = Clock::now();
+        Work work = bench.run();
+        double seconds =
+            std::chrono::duration<double>(Clock::now() - begin).count();
+        if (seconds < best) {
+            best = seconds;
+            result.work = work;
+        }
+        total += seconds;
+        ++result.iterations;
+    }
+    result.seconds = best;
+    return result;
+}
+
+static void printTableHeader() {
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(12) << "Time [us]" << std::setw(10) << "Views"
+              << std::setw(14) << "Leaf layouts" << std::setw(10) << "Runs"
+              << "\n";
+}
+
+static void printTableRow(Result const& result) {
+    std::cout << std::left << std::setw(40) << result.name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(12)
+              << result.seconds * 1e6 << std::setw(10) << result.work.numViews
+              << std::setw(14) << result.work.numLayouts << std::setw(10)
+              << result.iterations << "\n";
+}
+
+/// Prints one JSON object per line so results can be appended to a log and
+/// compared across releases
+static void printJSON(Result const& result) {
+    std::cout << std::setprecision(9) << "{\"name\":\"" << result.name
+              << "\",\"seconds\":" << result.seconds
+              << ",\"iterations\":" << result.iterations
+              << ",\"views\":" << result.work.numViews
+              << ",\"leafLayouts\":" << result.work.numLayouts << "}\n";
+}
+
+static void printUsage(char const* program) {
+    std::cerr << "Usage: " << program
+              << " [--json] [--filter <substring>] [--min-time <seconds>]\n";
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            config.json = true;
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            config.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            config.minTime = std::atof(argv[++i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (!config.json) {
+        printTableHeader();
+    }
+    for (auto& bench: makeBenchmarks()) {
+        if (bench.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        auto result = runBenchmark(bench, config.minTime);
+        if (config.json) {
+            printJSON(result);
+        }
+        else {
+            printTableRow(result);
+        }
+    }
+}
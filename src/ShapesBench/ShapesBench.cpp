@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numbers>
+#include <string>
+#include <vector>
+
+#include <Aether/Shapes.h>
+
+using namespace xui;
+using namespace vml::short_types;
+
+namespace {
+
+/// Amount of geometry a single run of a benchmark produces
+struct Work {
+    size_t numVertices = 0;
+    size_t numTriangles = 0;
+};
+
+struct Benchmark {
+    std::string name;
+    std::function<Work()> run;
+};
+
+struct Result {
+    std::string name;
+    Work work;
+    double seconds = 0;
+    size_t iterations = 0;
+};
+
+struct Config {
+    bool json = false;
+    std::string filter;
+    double minTime = 0.5;
+};
+
+/// Benchmark results are written to this to keep the optimizer from discarding
+/// the work
+volatile size_t sink = 0;
+
+} // namespace
+
+static std::vector<float2> convexPolygon(size_t n) {
+    std::vector<float2> result(n);
+    for (size_t i = 0; i < n; ++i) {
+        float angle = 2 * std::numbers::pi_v<float> * (float)i / (float)n;
+        result[i] = 500.0f * float2{ std::cos(angle), std::sin(angle) };
+    }
+    return result;
+}
+
+static std::vector<float2> starPolygon(size_t n) {
+    std::vector<float2> result(n);
+    for (size_t i = 0; i < n; ++i) {
+        float angle = 2 * std::numbers::pi_v<float> * (float)i / (float)n;
+        float radius = i % 2 == 0 ? 500.0f : 250.0f;
+        result[i] = radius * float2{ std::cos(angle), std::sin(angle) };
+    }
+    return result;
+}
+
+/// A band that winds around the origin. Half of the vertices lie on the outer
+/// and half on the inner side of the band, so the polygon is neither convex
+/// nor monotone
+static std::vector<float2> spiralPolygon(size_t n) {
+    size_t half = std::max<size_t>(n / 2, 2);
+    float turns = std::max(1.0f, std::sqrt((float)half) / 4);
+    float pitch = 10;
+    float maxAngle = 2 * std::numbers::pi_v<float> * turns;
+    auto point = [&](size_t i, float offset) {
+        float angle = maxAngle * (float)i / (float)(half - 1);
+        float radius = 20 + pitch * angle / (2 * std::numbers::pi_v<float>) +
+                       offset;
+        return radius * float2{ std::cos(angle), std::sin(angle) };
+    };
+    std::vector<float2> result;
+    result.reserve(2 * half);
+    for (size_t i = 0; i < half; ++i) {
+        result.push_back(point(i, pitch / 2));
+    }
+    for (size_t i = half; i > 0; --i) {
+        result.push_back(point(i - 1, 0));
+    }
+    return result;
+}
+
+/// The links of a node graph editor, i.e., S-shaped cubic curves between
+/// random points
+static std::vector<CubicBezier> graphCurves(size_t count) {
+    std::vector<CubicBezier> result(count);
+    unsigned state = 12345;
+    auto random = [&] {
+        state = state * 1664525u + 1013904223u;
+        return (float)(state >> 8) / (float)(1u << 24) * 2000.0f;
+    };
+    for (auto& curve: result) {
+        float2 begin = { random(), random() };
+        float2 end = { random(), random() };
+        float dx = std::max(std::abs(end.x - begin.x) / 2, 50.0f);
+        curve = { begin, begin + float2{ dx, 0 }, end - float2{ dx, 0 }, end };
+    }
+    return result;
+}
+
+/// Flattens \p curves into one polyline per curve
+static std::vector<std::vector<float2>> flattenCurves(
+    std::span<CubicBezier const> curves, BezierOptions options) {
+    std::vector<std::vector<float2>> result;
+    result.reserve(curves.size());
+    for (auto& curve: curves) {
+        auto& line = result.emplace_back();
+        pathBezier(curve, [&](float2 p) { line.push_back(p); }, options);
+    }
+    return result;
+}
+
+static Benchmark triangulateBench(std::string name,
+                                  std::vector<float2> polygon,
+                                  TriangulationOptions options = {}) {
+    return { std::move(name),
+             [polygon = std::move(polygon), options,
+              indices = std::vector<uint32_t>()]() mutable {
+        indices.resize(polygonIndexCount(polygon.size()));
+        size_t numIndices = triangulatePolygonInto(polygon, indices, options);
+        return Work{ polygon.size(), numIndices / 3 };
+    } };
+}
+
+static Benchmark lineMeshBench(std::string name,
+                               std::vector<std::vector<float2>> lines,
+                               LineMeshOptions options) {
+    return { std::move(name), [lines = std::move(lines), options,
+                               vertices = std::vector<float2>(),
+                               indices = std::vector<uint32_t>()]() mutable {
+        Work work;
+        for (auto& line: lines) {
+            auto size = lineMeshSize(line, options);
+            vertices.resize(size.numVertices);
+            indices.resize(size.numIndices);
+            auto written = buildLineMeshInto(line, vertices, indices, options);
+            work.numVertices += written.numVertices;
+            work.numTriangles += written.numIndices / 3;
+        }
+        return work;
+    } };
+}
+
+static std::vector<Benchmark> makeBenchmarks() {
+    std::vector<Benchmark> result;
+    auto curves = graphCurves(10'000);
+
+    // Curves
+    result.push_back({ "pathBezier/fixed/10k", [curves] {
+        Work work;
+        for (auto& curve: curves) {
+            pathBezier(curve, [&](float2) { ++work.numVertices; });
+        }
+        return work;
+    } });
+    result.push_back({ "pathBezier/tolerance/10k", [curves] {
+        Work work;
+        for (auto& curve: curves) {
+            pathBezier(curve, [&](float2) { ++work.numVertices; },
+                       { .tolerance = 0.25f });
+        }
+        return work;
+    } });
+    result.push_back({ "pathBeziers/tolerance/10k",
+                       [curves, vertices = std::vector<float2>()]() mutable {
+        BezierOptions options = { .tolerance = 0.25f };
+        size_t count = 0;
+        for (auto& curve: curves) {
+            count += bezierVertexCount(curve, options);
+        }
+        vertices.resize(count);
+        return Work{ pathBeziers(curves, vertices, {}, options), 0 };
+    } });
+    result.push_back({ "pathCircleSegment/10k", [] {
+        Work work;
+        for (int i = 0; i < 10'000; ++i) {
+            pathCircleSegment({ 10, 0 }, { 0, 0 }, std::numbers::pi_v<float>,
+                              [&](float2) { ++work.numVertices; });
+        }
+        return work;
+    } });
+
+    // Lines as drawn by the node editor
+    auto lines = flattenCurves(curves, { .tolerance = 0.25f });
+    result.push_back({ "buildLineMesh/graph/10k",
+                       [lines, vertices = std::vector<float2>(),
+                        indices = std::vector<uint32_t>()]() mutable {
+        vertices.clear();
+        indices.clear();
+        for (auto& line: lines) {
+            buildLineMesh(
+                line, [&](float2 p) { vertices.push_back(p); },
+                [&](uint32_t a, uint32_t b, uint32_t c) {
+                indices.insert(indices.end(), { a, b, c });
+            }, { .width = 2 });
+        }
+        return Work{ vertices.size(), indices.size() / 3 };
+    } });
+    result.push_back(
+        lineMeshBench("buildLineMeshInto/graph/10k", lines, { .width = 2 }));
+    result.push_back(lineMeshBench(
+        "buildLineMeshInto/graph-round/10k", lines,
+        { .width = 2,
+          .join = { .style = LineJoinOptions::Round },
+          .beginCap = { .style = LineCapOptions::Circle },
+          .endCap = { .style = LineCapOptions::Circle } }));
+    static float const dashPattern[] = { 10, 5 };
+    result.push_back(lineMeshBench("buildLineMeshInto/graph-dashed/10k", lines,
+                                   { .width = 2,
+                                     .dash = { .pattern = dashPattern } }));
+
+    // Polygons
+    for (size_t n: { 10, 100, 1'000, 10'000, 100'000 }) {
+        auto suffix = "/" + std::to_string(n);
+        auto convex = convexPolygon(n);
+        result.push_back(triangulateBench("triangulate/convex" + suffix,
+                                          convex));
+        result.push_back(triangulateBench(
+            "triangulate/convex-monotone" + suffix, convex,
+            { .isYMonotone = true,
+              .orientation = Orientation::Counterclockwise }));
+        result.push_back(
+            triangulateBench("triangulate/star" + suffix, starPolygon(n)));
+        result.push_back(
+            triangulateBench("triangulate/spiral" + suffix, spiralPolygon(n)));
+    }
+    for (size_t n: { 100, 10'000 }) {
+        auto outer = convexPolygon(n);
+        auto inner = starPolygon(n);
+        for (auto& p: inner) {
+            p *= 0.5f;
+        }
+        result.push_back({ "triangulate/holes/" + std::to_string(2 * n),
+                           [outer, inner,
+                            indices = std::vector<uint32_t>()]() mutable {
+            std::span<float2 const> contours[] = { outer, inner };
+            size_t numVertices = outer.size() + inner.size();
+            indices.resize(polygonIndexCount(numVertices, 2));
+            size_t numIndices = triangulatePolygonInto(contours, indices);
+            return Work{ numVertices, numIndices / 3 };
+        } });
+    }
+    return result;
+}
+
+/// Runs \p bench repeatedly for at least \p minTime seconds and records the
+/// fastest run
+static Result runBenchmark(Benchmark const& bench, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    Result result = { .name = bench.name };
+    double best = INFINITY;
+    double total = 0;
+    while (total < minTime || result.iterations < 3) {
+        auto begin = Clock::now();
+        Work work = bench.run();
+        double seconds =
+            std::chrono::duration<double>(Clock::now() - begin).count();
+        sink = sink + work.numVertices;
+        if (seconds < best) {
+            best = seconds;
+            result.work = work;
+        }
+        total += seconds;
+        ++result.iterations;
+    }
+    result.seconds = best;
+    return result;
+}
+
+static double perSecond(size_t count, double seconds) {
+    return seconds > 0 ? (double)count / seconds : 0;
+}
+
+static void printTableHeader() {
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right
+              << std::setw(12) << "Time [ms]" << std::setw(14) << "Vertices/s"
+              << std::setw(14) << "Triangles/s" << std::setw(10) << "Runs"
+              << "\n";
+}
+
+static void printTableRow(Result const& result) {
+    std::cout << std::left << std::setw(40) << result.name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(12)
+              << result.seconds * 1000 << std::scientific
+              << std::setprecision(3) << std::setw(14)
+              << perSecond(result.work.numVertices, result.seconds)
+              << std::setw(14)
+              << perSecond(result.work.numTriangles, result.seconds)
+              << std::setw(10) << result.iterations << "\n";
+}
+
+/// Prints one JSON object per line so results can be appended to a log and
+/// compared across releases
+static void printJSON(Result const& result) {
+    std::cout << std::setprecision(9) << "{\"name\":\"" << result.name
+              << "\",\"seconds\":" << result.seconds
+              << ",\"iterations\":" << result.iterations
+              << ",\"vertices\":" << result.work.numVertices
+              << ",\"triangles\":" << result.work.numTriangles
+              << ",\"verticesPerSecond\":"
+              << perSecond(result.work.numVertices, result.seconds)
+              << ",\"trianglesPerSecond\":"
+              << perSecond(result.work.numTriangles, result.seconds) << "}\n";
+}
+
+static void printUsage(char const* program) {
+    std::cerr << "Usage: " << program
+              << " [--json] [--filter <substring>] [--min-time <seconds>]\n";
+}
+
+int main(int argc, char** argv) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            config.json = true;
+        }
+        else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            config.filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            config.minTime = std::atof(argv[++i]);
+        }
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (!config.json) {
+        printTableHeader();
+    }
+    for (auto& bench: makeBenchmarks()) {
+        if (bench.name.find(config.filter) == std::string::npos) {
+            continue;
+        }
+        auto result = runBenchmark(bench, config.minTime);
+        if (config.json) {
+            printJSON(result);
+        }
+        else {
+            printTableRow(result);
+        }
+    }
+}
@@ -253,6 +253,30 @@ struct DrawView: public View {
             ctx->addPolygon(vertices, { .fill = Color::Red() },
                             { .isYMonotone = true });
         }
+        { // Frame with a hole
+            float2 outer[] = { { 20, 220 },
+                               { 80, 220 },
+                               { 80, 280 },
+                               { 20, 280 } };
+            float2 inner[] = { { 35, 235 },
+                               { 65, 235 },
+                               { 65, 265 },
+                               { 35, 265 } };
+            std::span<float2 const> contours[] = { outer, inner };
+            ctx->addPolygon(contours, { .fill = Color::Red() },
+                            { .fillRule = FillRule::EvenOdd });
+        }
+        { // Dashed outline
+            float2 line[] = { { 20, 300 },
+                              { 80, 300 },
+                              { 80, 360 },
+                              { 20, 360 } };
+            float pattern[] = { 10, 5 };
+            ctx->addLine(line, { .fill = Color::Red() },
+                         { .width = 4,
+                           .closed = true,
+                           .dash = { .pattern = pattern } });
+        }
         { // More complex Y monotone polygon
             float2 vertices[] = { { 49, 0 },   { 97, 126 }, { 92, 144 },
                                   { 64, 151 }, { 48, 200 }, { 14, 92 },